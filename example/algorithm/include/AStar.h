@@ -7,8 +7,10 @@
 #define __ASTAR_HPP_8F637DB91972F6C878D41D63F7E7214F__
 
 #include <vector>
+#include <algorithm>
 #include <functional>
 #include <set>
+#include <cstdint>
 
 namespace AStar
 {
@@ -26,50 +28,325 @@ namespace AStar
     using HeuristicFunction = std::function<uint(Vec2i, Vec2i)>;
     using CoordinateList = std::vector<Vec2i>;
 
+    // 节点存放在SearchWorkspace的节点池中，parent为父节点在池中的下标
     struct Node
     {
+        static constexpr uint NONE = 0xFFFFFFFF;
+
         uint G, H;
         Vec2i coordinates;
-        Node *parent;
+        uint parent;
+        bool closed;
 
-        Node(Vec2i coord_, Node *parent_ = nullptr);
+        Node(Vec2i coord_, uint parent_ = NONE);
         uint getScore();
     };
 
-    using NodeSet = std::vector<Node*>;
+    using NodeSet = std::vector<Node>;
+
+    // 4叉堆实现的open list，存放节点下标，按f值取最小，f值相同时优先取h值小（更靠近终点）的节点
+    // 不支持decrease-key：节点的G值降低后重新入堆，旧的项在出堆时由调用者按closed标记跳过
+    class OpenList
+    {
+    public:
+        void push(uint node_, uint score_, uint H_);
+        uint pop();
+        uint top() const { return heap.front().node; }
+        uint topScore() const { return heap.front().score; }
+        bool empty() const { return heap.empty(); }
+        std::size_t size() const { return heap.size(); }
+        void clear() { heap.clear(); }
+
+    private:
+        struct Entry
+        {
+            uint score, H;
+            uint node;
+        };
+        static bool less(const Entry& left_, const Entry& right_)
+        {
+            return left_.score < right_.score ||
+                   (left_.score == right_.score && left_.H < right_.H);
+        }
+
+        std::vector<Entry> heap;
+    };
+
+    // 二维碰撞位图，第(x, y)个cell对应第x * size.y + y位；构建后只读，可被多个Generator共享
+    class CollisionLayer
+    {
+    public:
+        CollisionLayer(Vec2i size_ = { 0, 0 });
+        Vec2i getSize() const { return size; }
+        bool isBlocked(Vec2i coordinates_) const
+        {
+            std::size_t index = static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y;
+            return (bits[index >> 6] >> (index & 63)) & 1;
+        }
+        void set(Vec2i coordinates_)
+        {
+            std::size_t index = static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y;
+            bits[index >> 6] |= std::uint64_t(1) << (index & 63);
+        }
+        void reset(Vec2i coordinates_)
+        {
+            std::size_t index = static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y;
+            bits[index >> 6] &= ~(std::uint64_t(1) << (index & 63));
+        }
+        void clear();
+        uint count() const;
+
+    private:
+        Vec2i size;
+        std::vector<std::uint64_t> bits;
+    };
+
+    // 二维附加代价层，每个cell一个字节，为进入该cell的额外代价（直行一步的基础代价为10）
+    // BLOCKED表示禁止通行；构建后只读，可被多个Generator共享
+    class CostLayer
+    {
+    public:
+        static const std::uint8_t BLOCKED = 255;
+
+        CostLayer(Vec2i size_ = { 0, 0 });
+        Vec2i getSize() const { return size; }
+        std::uint8_t getCost(Vec2i coordinates_) const
+        {
+            return costs[static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y];
+        }
+        void setCost(Vec2i coordinates_, std::uint8_t cost_)
+        {
+            costs[static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y] = cost_;
+        }
+        // 与seed_ 8邻域连通的BLOCKED区域（含seed_），seed_不是BLOCKED时返回空
+        // 用于起终点位于禁止区域内时解除整个区域，使路径能从区域边缘进出
+        CoordinateList blockedRegion(Vec2i seed_) const;
+
+    private:
+        Vec2i size;
+        std::vector<std::uint8_t> costs;
+    };
+
+    // ALT（A*、landmark、三角不等式）启发函数使用的距离表
+    // 保存若干landmark到每个cell的最短路代价（直行10、对角14），同一cell的各landmark连续存放；
+    // 由d(v, t) >= |d(L, t) - d(L, v)|得到的下界在建筑群附近比几何距离紧得多
+    // 表应由与搜索相同的碰撞层计算，构建后只读，可被多个Generator共享
+    class LandmarkTable
+    {
+    public:
+        static constexpr uint UNREACHABLE = 0xFFFFFFFF;
+
+        LandmarkTable(Vec2i size_ = { 0, 0 }, uint count_ = 0);
+        Vec2i getSize() const { return size; }
+        uint getCount() const { return count; }
+        // 第(x, y)个cell到各landmark的代价，共getCount()个
+        const uint* getDistances(Vec2i coordinates_) const
+        {
+            return &distances[(static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y) *
+                              count];
+        }
+        void setDistance(uint landmark_, Vec2i coordinates_, uint distance_)
+        {
+            distances[(static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y) *
+                      count + landmark_] = distance_;
+        }
+        // 原始存储，用于持久化
+        uint* data() { return distances.data(); }
+        const uint* data() const { return distances.data(); }
+        std::size_t dataSize() const { return distances.size(); }
+
+    private:
+        Vec2i size;
+        uint count;
+        std::vector<uint> distances;
+    };
+
+    // 可在多次查询之间复用的搜索状态：节点池、open list以及按cell索引的节点下标
+    // reset只递增generation，stamp不等于当前generation的下标视为空，无需清空整个数组，
+    // 因此一次查询的开销只与实际访问的cell数有关；数组按需扩容，不同尺寸的网格可共用
+    // 双向搜索时两个方向共用节点池，反向节点的下标存放在第二个平面（cell编号加上cell总数），
+    // 反向的open list为reverseOpenList
+    class SearchWorkspace
+    {
+    public:
+        SearchWorkspace();
+        void reset(Vec2i worldSize_, uint planes_ = 1);
+        uint find(std::size_t cell_) const
+        {
+            return stamps[cell_] == generation ? nodeIndex[cell_] : Node::NONE;
+        }
+        void assign(std::size_t cell_, uint node_)
+        {
+            nodeIndex[cell_] = node_;
+            stamps[cell_] = generation;
+        }
+        uint addNode(Vec2i coordinates_, uint parent_, uint G_, uint H_);
+
+        NodeSet nodes;
+        OpenList openList, reverseOpenList;
+
+    private:
+        std::vector<uint> nodeIndex, stamps;
+        uint generation;
+    };
+
+    struct GridView;
 
     class Generator
     {
+        // setHeuristic传入的是否为内置启发函数，内置的在搜索中直接内联
+        enum class HeuristicKind { manhattan, euclidean, octagonal, custom };
+
+        GridView gridView() const;
         bool detectCollision(Vec2i coordinates_);
-        Node* findNodeOnList(NodeSet& nodes_, Vec2i coordinates_);
-        void releaseNodes(NodeSet& nodes_);
+        bool isInside(Vec2i coordinates_) const;
+        SearchWorkspace& activeWorkspace();
+        std::size_t cellIndex(Vec2i coordinates_) const
+        {
+            return static_cast<std::size_t>(coordinates_.x) * worldSize.y + coordinates_.y;
+        }
+        uint stepCost(Vec2i to_, uint direction_);
+        uint estimate(Vec2i coordinates_, Vec2i goal_);
+        CoordinateList findPathEngine(Vec2i source_, Vec2i target_);
+        CoordinateList findPathJPS(Vec2i source_, Vec2i target_);
+        CoordinateList findPathBidirectional(Vec2i source_, Vec2i target_);
+        bool hasForcedNeighbour(Vec2i coordinates_, Vec2i direction_);
+        bool jump(Vec2i coordinates_, Vec2i direction_, Vec2i target_, Vec2i& jumpPoint_);
+        bool lineOfSight(Vec2i from_, Vec2i to_, uint& extraCost_, uint& cellCount_);
+        uint legCost(Vec2i from_, Vec2i to_, uint extraCost_, uint cellCount_);
 
     public:
         Generator();
+        // 同时按新尺寸重建临时障碍位图，之前添加/移除的障碍会被清空
         void setWorldSize(Vec2i worldSize_);
         void setDiagonalMovement(bool enable_);
         void setHeuristic(HeuristicFunction heuristic_);
+        // 跳点搜索（JPS）：沿直线和对角方向跳跃，只扩展有强制邻居的跳点，路径代价与A*相同
+        // 仅在允许对角移动且未设置代价层（代价一致）时生效，否则仍使用A*
+        void setJumpPointSearch(bool enable_);
+        // 任意角度搜索（Theta*）：扩展时若父节点与后继之间直线可通行（supercover检查），
+        // 则直接连接，findPath返回的是拐点序列（相邻两点之间直线无碰撞）而非逐格路径；优先于JPS
+        void setAnyAngle(bool enable_);
+        // 双向A*：从起点和终点同时搜索，每次扩展open list较小的一侧，
+        // 某一侧的最小f值不小于已发现的最短相遇路径时停止；启发函数一致（如octagonal）时路径最优
+        // 仅在不使用任意角度搜索和JPS时生效
+        void setBidirectional(bool enable_);
+        // 引用预先计算的碰撞层（尺寸需与setWorldSize一致），不拷贝，nullptr表示不使用
+        void setCollisionLayer(const CollisionLayer* layer_);
+        // 引用附加代价层（尺寸需与setWorldSize一致），nullptr表示不使用
+        void setCostLayer(const CostLayer* layer_);
+        // 引用landmark距离表（尺寸需与setWorldSize一致），nullptr表示不使用；设置后忽略setHeuristic，
+        // 启发函数直接取octagonal（任意角度搜索为euclidean，ALT下界相应缩小）与ALT下界的较大值
+        void setLandmarks(const LandmarkTable* landmarks_);
+        // 使用外部的搜索状态（不拷贝），可让多个短生命周期的Generator共用同一份内存；
+        // nullptr表示使用Generator自带的状态。同一时刻只能有一个Generator使用同一个workspace
+        void setWorkspace(SearchWorkspace* workspace_);
         CoordinateList findPath(Vec2i source_, Vec2i target_);
+        // 在当前的障碍与代价设置下合并拐点：依次从每个点直连最远的可直线到达、且代价不增加的点
+        CoordinateList smoothPath(const CoordinateList& path_);
+        // 临时障碍叠加在碰撞层之上：addCollision优先级最高，
+        // removeCollision可解除碰撞层和代价层中的障碍；超出worldSize的坐标被忽略
         void addCollision(Vec2i coordinates_);
         void removeCollision(Vec2i coordinates_);
         void clearCollisions();
+        // 上一次findPath扩展（加入closed）的节点数
+        uint getExpandedNodes() const { return expandedNodes; }
 
     private:
         HeuristicFunction heuristic;
-        CoordinateList direction, walls;
+        HeuristicKind heuristicKind;
+        const CollisionLayer* collisionLayer;
+        const CostLayer* costLayer;
+        const LandmarkTable* landmarks;
+        CoordinateList direction;
+        CollisionLayer walls, openings;
         Vec2i worldSize;
         uint directions;
+        SearchWorkspace ownWorkspace;
+        SearchWorkspace* workspace;
+        bool jumpPointSearch;
+        bool anyAngle;
+        bool bidirectional;
+        uint expandedNodes;
     };
 
     class Heuristic
     {
-        static Vec2i getDelta(Vec2i source_, Vec2i target_);
-
     public:
         static uint manhattan(Vec2i source_, Vec2i target_);
         static uint euclidean(Vec2i source_, Vec2i target_);
         static uint octagonal(Vec2i source_, Vec2i target_);
     };
+
+    // 搜索循环中调用的小函数定义在头文件中，以便SearchEngine的实例完全内联
+    inline Node::Node(Vec2i coordinates_, uint parent_)
+    {
+        parent = parent_;
+        coordinates = coordinates_;
+        G = H = 0;
+        closed = false;
+    }
+
+    inline uint Node::getScore()
+    {
+        return G + H;
+    }
+
+    inline void OpenList::push(uint node_, uint score_, uint H_)
+    {
+        std::size_t i = heap.size();
+        Entry entry{ score_, H_, node_ };
+        heap.push_back(entry);
+        while (i > 0) {
+            std::size_t parent = (i - 1) / 4;
+            if (!less(entry, heap[parent])) {
+                break;
+            }
+            heap[i] = heap[parent];
+            i = parent;
+        }
+        heap[i] = entry;
+    }
+
+    inline uint OpenList::pop()
+    {
+        uint top = heap.front().node;
+        Entry entry = heap.back();
+        heap.pop_back();
+        std::size_t n = heap.size();
+        if (n == 0) {
+            return top;
+        }
+        std::size_t i = 0;
+        while (true) {
+            std::size_t first = 4 * i + 1;
+            if (first >= n) {
+                break;
+            }
+            std::size_t best = first;
+            std::size_t last = std::min(first + 4, n);
+            for (std::size_t c = first + 1; c < last; ++c) {
+                if (less(heap[c], heap[best])) {
+                    best = c;
+                }
+            }
+            if (!less(heap[best], entry)) {
+                break;
+            }
+            heap[i] = heap[best];
+            i = best;
+        }
+        heap[i] = entry;
+        return top;
+    }
+
+    inline uint SearchWorkspace::addNode(Vec2i coordinates_, uint parent_, uint G_, uint H_)
+    {
+        nodes.emplace_back(coordinates_, parent_);
+        nodes.back().G = G_;
+        nodes.back().H = H_;
+        return static_cast<uint>(nodes.size() - 1);
+    }
 }
 
 #endif // __ASTAR_HPP_8F637DB91972F6C878D41D63F7E7214F__
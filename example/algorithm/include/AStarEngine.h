@@ -0,0 +1,286 @@
+#ifndef ASTAR_ENGINE_H
+#define ASTAR_ENGINE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "AStar.h"
+
+namespace AStar
+{
+    // 搜索看到的网格：临时障碍叠加在碰撞层与代价层之上（规则与Generator::addCollision等一致），
+    // 只保存指针，由Generator在每次查询时构造
+    struct GridView
+    {
+        Vec2i size;
+        const CollisionLayer* walls;
+        const CollisionLayer* openings;
+        const CollisionLayer* collisionLayer;
+        const CostLayer* costLayer;
+
+        bool isInside(Vec2i coordinates_) const
+        {
+            return coordinates_.x >= 0 && coordinates_.x < size.x &&
+                   coordinates_.y >= 0 && coordinates_.y < size.y;
+        }
+        bool isBlocked(Vec2i coordinates_) const
+        {
+            if (!isInside(coordinates_) || walls->isBlocked(coordinates_)) {
+                return true;
+            }
+            if ((collisionLayer != nullptr && collisionLayer->isBlocked(coordinates_)) ||
+                (costLayer != nullptr &&
+                 costLayer->getCost(coordinates_) == CostLayer::BLOCKED)) {
+                return !openings->isBlocked(coordinates_);
+            }
+            return false;
+        }
+        // 进入cell的附加代价，被removeCollision解除的BLOCKED按0计
+        uint extraCost(Vec2i coordinates_) const
+        {
+            uint cost = costLayer->getCost(coordinates_);
+            return cost != CostLayer::BLOCKED ? cost : 0;
+        }
+        std::size_t cellIndex(Vec2i coordinates_) const
+        {
+            return static_cast<std::size_t>(coordinates_.x) * size.y + coordinates_.y;
+        }
+    };
+
+    // 整数版supercover直线：连接两个cell中心，经过棱角时同时检查两侧的cell
+    // 依次对经过的cell（不含起点）调用enter_，对棱角两侧的cell调用isBlocked_；
+    // enter_返回false或isBlocked_返回true时停止并返回false
+    template <class BlockedT, class EnterT>
+    bool supercoverLine(Vec2i from_, Vec2i to_, BlockedT isBlocked_, EnterT enter_)
+    {
+        int dx = to_.x - from_.x, dy = to_.y - from_.y;
+        int nx = abs(dx), ny = abs(dy);
+        int sx = dx > 0 ? 1 : -1, sy = dy > 0 ? 1 : -1;
+        Vec2i c = from_;
+        for (int ix = 0, iy = 0; ix < nx || iy < ny;) {
+            long long decision = static_cast<long long>(1 + 2 * ix) * ny -
+                                 static_cast<long long>(1 + 2 * iy) * nx;
+            if (decision == 0) {
+                if (isBlocked_(Vec2i{ c.x + sx, c.y }) || isBlocked_(Vec2i{ c.x, c.y + sy })) {
+                    return false;
+                }
+                c.x += sx;
+                c.y += sy;
+                ix++;
+                iy++;
+            }
+            else if (decision < 0) {
+                c.x += sx;
+                ix++;
+            }
+            else {
+                c.y += sy;
+                iy++;
+            }
+            if (!enter_(c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // ALT下界：各landmark给出的|d(L, t) - d(L, v)|取最大，任一端不连通的landmark跳过
+    inline uint landmarkBound(const LandmarkTable& table_, Vec2i source_, Vec2i target_)
+    {
+        uint bound = 0;
+        const uint* from = table_.getDistances(source_);
+        const uint* to = table_.getDistances(target_);
+        for (uint i = 0, n = table_.getCount(); i < n; ++i) {
+            if (from[i] == LandmarkTable::UNREACHABLE || to[i] == LandmarkTable::UNREACHABLE) {
+                continue;
+            }
+            bound = std::max(bound, from[i] > to[i] ? from[i] - to[i] : to[i] - from[i]);
+        }
+        return bound;
+    }
+
+    // SearchEngine的策略类型：启发函数、邻域与边权。均为可内联的函数对象，
+    // 组合后的搜索循环中没有函数指针或std::function调用
+    namespace policy
+    {
+        struct Manhattan
+        {
+            uint operator()(Vec2i source_, Vec2i target_) const
+            {
+                return static_cast<uint>(10 * (abs(source_.x - target_.x) +
+                                               abs(source_.y - target_.y)));
+            }
+        };
+
+        struct Euclidean
+        {
+            uint operator()(Vec2i source_, Vec2i target_) const
+            {
+                int dx = abs(source_.x - target_.x), dy = abs(source_.y - target_.y);
+                return static_cast<uint>(10 * sqrt(pow(dx, 2) + pow(dy, 2)));
+            }
+        };
+
+        struct Octagonal
+        {
+            uint operator()(Vec2i source_, Vec2i target_) const
+            {
+                int dx = abs(source_.x - target_.x), dy = abs(source_.y - target_.y);
+                return 10 * (dx + dy) + (-6) * std::min(dx, dy);
+            }
+        };
+
+        // 通过setHeuristic传入的任意函数，保留运行时调用
+        struct Function
+        {
+            const HeuristicFunction* function;
+
+            uint operator()(Vec2i source_, Vec2i target_) const
+            {
+                return (*function)(source_, target_);
+            }
+        };
+
+        // 几何启发函数与ALT下界取较大值
+        template <class BaseT>
+        struct Landmark
+        {
+            const LandmarkTable* table;
+            BaseT base;
+
+            uint operator()(Vec2i source_, Vec2i target_) const
+            {
+                return std::max(base(source_, target_), landmarkBound(*table, source_, target_));
+            }
+        };
+
+        // 邻域的方向顺序与Generator::direction一致（前4个为直行），保证各实现的扩展顺序相同
+        struct FourConnected
+        {
+            static constexpr uint count = 4;
+            static Vec2i offset(uint i_)
+            {
+                constexpr int dx[4] = { 0, 1, 0, -1 };
+                constexpr int dy[4] = { 1, 0, -1, 0 };
+                return { dx[i_], dy[i_] };
+            }
+        };
+
+        struct EightConnected
+        {
+            static constexpr uint count = 8;
+            static Vec2i offset(uint i_)
+            {
+                constexpr int dx[8] = { 0, 1, 0, -1, -1, 1, -1, 1 };
+                constexpr int dy[8] = { 1, 0, -1, 0, -1, 1, 1, -1 };
+                return { dx[i_], dy[i_] };
+            }
+        };
+
+        // 直行10、对角14
+        struct UniformCost
+        {
+            uint operator()(const GridView&, Vec2i, uint direction_) const
+            {
+                return direction_ < 4 ? 10 : 14;
+            }
+        };
+
+        // 在基础代价上叠加进入cell的附加代价，对角按1.4倍计
+        struct LayerCost
+        {
+            uint operator()(const GridView& grid_, Vec2i to_, uint direction_) const
+            {
+                uint extra = grid_.extraCost(to_);
+                return direction_ < 4 ? 10 + extra : 14 + extra * 14 / 10;
+            }
+        };
+    }
+
+    // 编译期组合启发函数、邻域与边权的A*，与Generator默认模式（非JPS、任意角度、双向）的
+    // 结果逐点相同；Generator::findPath按当前设置分派到预先实例化的组合
+    template <class HeuristicT, class NeighborhoodT, class CostT>
+    class SearchEngine
+    {
+    public:
+        SearchEngine(const GridView& grid_, HeuristicT heuristic_ = HeuristicT(),
+                     CostT cost_ = CostT())
+            : grid(grid_), heuristic(heuristic_), cost(cost_), expandedNodes(0)
+        {
+        }
+
+        // 返回终点在前的逐格路径；终点不可达时返回最后扩展的节点到起点的路径
+        CoordinateList findPath(Vec2i source_, Vec2i target_, SearchWorkspace& workspace_)
+        {
+            expandedNodes = 0;
+            workspace_.reset(grid.size);
+            NodeSet& nodes = workspace_.nodes;
+            OpenList& openList = workspace_.openList;
+            uint current = workspace_.addNode(source_, Node::NONE, 0, heuristic(source_, target_));
+            workspace_.assign(grid.cellIndex(source_), current);
+            openList.push(current, nodes[current].G + nodes[current].H, nodes[current].H);
+
+            while (!openList.empty()) {
+                uint node = openList.pop();
+                if (nodes[node].closed) {
+                    continue;  // 节点重新入堆后留下的旧项
+                }
+                current = node;
+
+                if (nodes[current].coordinates == target_) {
+                    break;
+                }
+
+                nodes[current].closed = true;
+                ++expandedNodes;
+
+                // nodes在循环中可能扩容，只保存值而不保存引用
+                Vec2i currentCoordinates = nodes[current].coordinates;
+                uint currentG = nodes[current].G;
+                for (uint i = 0; i < NeighborhoodT::count; ++i) {
+                    Vec2i newCoordinates(currentCoordinates + NeighborhoodT::offset(i));
+                    if (grid.isBlocked(newCoordinates)) {
+                        continue;
+                    }
+                    std::size_t cell = grid.cellIndex(newCoordinates);
+                    uint successor = workspace_.find(cell);
+                    if (successor != Node::NONE && nodes[successor].closed) {
+                        continue;
+                    }
+
+                    uint totalCost = currentG + cost(grid, newCoordinates, i);
+                    if (successor == Node::NONE) {
+                        successor = workspace_.addNode(newCoordinates, current, totalCost,
+                                                       heuristic(newCoordinates, target_));
+                        workspace_.assign(cell, successor);
+                        openList.push(successor, nodes[successor].G + nodes[successor].H,
+                                      nodes[successor].H);
+                    }
+                    else if (totalCost < nodes[successor].G) {
+                        nodes[successor].parent = current;
+                        nodes[successor].G = totalCost;
+                        openList.push(successor, nodes[successor].G + nodes[successor].H,
+                                      nodes[successor].H);
+                    }
+                }
+            }
+
+            CoordinateList path;
+            for (uint node = current; node != Node::NONE; node = nodes[node].parent) {
+                path.push_back(nodes[node].coordinates);
+            }
+            return path;
+        }
+
+        // 上一次findPath扩展（加入closed）的节点数
+        uint getExpandedNodes() const { return expandedNodes; }
+
+    private:
+        GridView grid;
+        HeuristicT heuristic;
+        CostT cost;
+        uint expandedNodes;
+    };
+}
+
+#endif
@@ -6,10 +6,20 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include "AStar.h"
+#include "astar_3d.h"
 #include "current_game_info.h"
+#include "dstar_lite.h"
 #include "mtuav_sdk_planner.h"
+#include "esdf_layer.h"
+#include "landmark_set.h"
 #include "mtuav_sdk_types.h"
+#include "occupancy_grid.h"
+#include "occupancy_pyramid.h"
+#include "path_cache.h"
 #include "planner.h"
+#include "reservation_table.h"
+#include "semantic_cost_map.h"
 #include "traj_generation.hpp"
 
 // 用于表示当前无人机信息
@@ -57,6 +67,28 @@ class myAlgorithm : public Algorithm {
         
     }
 
+    // 一条待规划的航线：起终点、按请求顺序分配的巡航高度，以及规划得到的拐点与轨迹
+    struct RouteRequest {
+        DroneStatus drone;
+        Vec3 start;
+        Vec3 end;
+        int altitude_index = 0;  // 在_altitude_drone_count中的下标
+        int altitude = 0;
+        int grid_layer = 0;
+        Grid3 start_cell = {0, 0, 0};
+        Grid3 end_cell = {0, 0, 0};
+        int64_t takeoff_time = 0;  // 毫秒时间戳，与发布的FlightPlan.takeoff_timestamp一致
+        bool cached = false;  // 拐点来自路径缓存
+        std::vector<Grid3> corners;
+        std::vector<Segment> traj_segs;
+        bool success = false;
+    };
+    // 批量规划时每个线程独占的搜索状态
+    struct PlanningWorkspace {
+        AStar::SearchWorkspace search;
+        AStar3D::Workspace search_3d;
+    };
+
     // 需要实现自己的求解函数，从而生成飞行计划
     // solve函数中求解当前环境下算法输出，并传递给仿真系统
     int64_t solve();
@@ -64,17 +96,52 @@ class myAlgorithm : public Algorithm {
     // * 需要选手自行添加所需的函数
     // 示例：给定起点、终点，返回无人机WayPoint飞行轨迹与飞行时间
     std::tuple<std::vector<Segment>, int64_t> waypoints_generation(Vec3 start, Vec3 end);
-    // 示例：给定起点、终点与无人机，返回无人机trajectory飞行轨迹与飞行时间
-    std::tuple<std::vector<Segment>, int64_t> trajectory_generation(Vec3 start, Vec3 end, DroneStatus drone);
-    std::tuple<std::vector<Segment>, int64_t> trajectory_replan(Vec3 start, Vec3 end, DroneStatus drone);
+    // 示例：给定起点、终点、无人机与起飞时间戳，返回无人机trajectory飞行轨迹与飞行时间
+    // takeoff_time需与下发的FlightPlan.takeoff_timestamp相同，冲突检查与预约都以它为准
+    std::tuple<std::vector<Segment>, int64_t> trajectory_generation(Vec3 start, Vec3 end, DroneStatus drone,
+                                                                    int64_t takeoff_time);
+    std::tuple<std::vector<Segment>, int64_t> trajectory_replan(Vec3 start, Vec3 end, DroneStatus drone,
+                                                                int64_t takeoff_time);
+    // 批量规划多条航线：各航线的搜索与轨迹生成在线程池中并行，之后按请求顺序写入缓存、
+    // 做时空冲突检查并预约，结果写回各请求
+    void plan_routes(std::vector<RouteRequest>& requests);
+    // 搜索一条航线的拐点（缓存未命中时）并生成轨迹，只读共享数据，可在多个线程中同时调用
+    void search_route(RouteRequest& request, PlanningWorkspace& workspace);
+    // 合并一条已规划的航线：写入缓存、按request.takeoff_time做冲突检查、时空重规划与预约，
+    // 只能在主线程中依次调用
+    void commit_route(RouteRequest& request);
+    // 由起终点与巡航段的拐点生成起飞、巡航、降落合并后的轨迹，altitude为grid_layer对应的巡航高度
+    bool build_trajectory(Vec3 start, Vec3 end, int altitude, int grid_layer,
+                          const std::vector<Grid3>& corners, std::vector<Segment>& traj_segs);
     // 打印segment的信息
     std::string segments_to_string(std::vector<Segment> segs);
-
-    // 方便在alogrithm.cpp中调用
-    std::vector<std::vector<std::vector<int>>> _map_grid;
-    int _cell_size_x;
-    int _cell_size_y;
-    int _cell_size_z;
+    // 检查相邻航点间的直线航段是否穿过障碍物并打印
+    void log_blocked_legs(const std::vector<Vec3>& points);
+    // 借助距离层检查巡航段的最小离障距离并打印
+    void log_clearance(const std::vector<Segment>& segs);
+
+    // 方便在alogrithm.cpp中调用，网格尺寸、原点与cell大小均由_map_grid记录
+    OccupancyGrid _map_grid;
+    // 由_map_grid构建的多分辨率金字塔，用于分层路径规划
+    OccupancyPyramid _grid_pyramid;
+    // 70~110m巡航高度上的ALT距离表，后台计算，用于最细层Theta*与悬停重规划D* Lite的启发函数
+    LandmarkSet _landmarks;
+    // 各巡航高度的离障距离层，用于轨迹的离障检查
+    EsdfLayerCache _esdf_layers;
+    // 语义代价层，A*的附加边权
+    SemanticCostMap _semantic_costs;
+    // 在各次规划之间复用的A*搜索状态，避免每次查询重新分配与清空整张地图大小的数组
+    AStar::SearchWorkspace _search_workspace;
+    AStar3D::Workspace _search_workspace_3d;
+    // 批量规划的线程数，0表示按CPU核数；各线程的搜索状态同样在各次solve之间复用
+    int _planning_threads = 0;
+    std::vector<std::unique_ptr<PlanningWorkspace>> _planning_workspaces;
+    // 不带临时障碍的规划结果缓存，上面的网格或代价层重建后需调用invalidate
+    PathCache _path_cache;
+    // 已发布航线的时空预约表，每次solve时重建，用于新航线与其他无人机的冲突检查
+    ReservationTable _reservations;
+    // 悬停无人机的增量重规划状态，按无人机id保存，无人机降落后释放
+    std::map<std::string, DStarLite> _replanners;
     // 记录70 80 90 100 110的高度上航线的数量
     std::vector<int> _altitude_drone_count;
     // 建立无人机id与航线间的映射
@@ -0,0 +1,98 @@
+#ifndef ASTAR_3D_H
+#define ASTAR_3D_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "AStar.h"
+#include "mtuav_sdk_types.h"
+#include "occupancy_grid.h"
+#include "reservation_table.h"
+#include "segment_collision_checker.h"
+
+namespace mtuav::algorithm {
+
+// 跨高度层的三维A*
+// 在占据网格的若干高度层之间搜索，每一步为同层8邻域平移或垂直升降一层，
+// 边权为按DroneLimits最大水平、垂直速度换算的飞行时间（秒），因此得到的是飞行时间最短的路径；
+// 启发函数为水平对角距离与高度差各自的飞行时间之和，在该移动模型下是可采纳且一致的
+class AStar3D {
+   public:
+    // 可在多次查询之间复用的搜索状态
+    // 各数组按cell编号索引，stamp不等于当前generation的项视为未访问，每次查询无需清空
+    struct Workspace {
+        std::vector<float> g;
+        // 沿当前父节点链到达cell的纯飞行时间（秒），不含代价层与升降惩罚，用于时空预约查询；
+        // 以及cell所在航段（同一方向的连续移动）的起始时间与已飞长度（米）
+        std::vector<float> time;
+        std::vector<float> leg_start;
+        std::vector<float> leg_length;
+        std::vector<uint32_t> parent;
+        std::vector<uint32_t> stamp;
+        std::vector<uint8_t> state;
+        std::vector<std::pair<float, uint32_t>> open;  // (f, 编号)组成的小顶堆
+        uint32_t generation = 0;
+    };
+
+    AStar3D(const OccupancyGrid& grid, const DroneLimits& limits);
+
+    // 限制搜索的高度范围（米），与网格范围及DroneLimits的飞行高度限制取交集
+    void set_altitude_range(double min_z, double max_z);
+    // 每改变一层高度附加的时间（秒），用于抑制频繁升降
+    void set_climb_penalty(double seconds);
+    // 附加代价层，含义同AStar::Generator::setCostLayer，代价10相当于多飞一步的时间；
+    // 起点或终点位于BLOCKED区域时，与其连通的整个区域可以通行
+    void set_cost_layer(const AStar::CostLayer* cost_layer);
+    // 使用外部的搜索状态（不拷贝），nullptr表示使用自带的状态
+    void set_workspace(Workspace* workspace);
+    // 时空搜索：按估计的到达时间（departure_ms加上路径的飞行时间）避开其他无人机预约的cell，
+    // owner为本机的预约者编号；不支持原地等待，起点和终点不受预约限制。nullptr表示不使用
+    // 飞行时间按TrajectoryGeneration的速度曲线估计：每个航段从静止加速、在拐点减速到静止
+    void set_reservations(const ReservationTable* reservations, uint32_t owner,
+                          int64_t departure_ms);
+
+    // 搜索路径，返回经过的全部cell（终点在前，与AStar::Generator::findPath一致），失败时返回空
+    // extra_collisions为额外的临时障碍，不会阻塞起点和终点
+    std::vector<Grid3> find_path(Grid3 source, Grid3 target,
+                                 const std::vector<Grid3>& extra_collisions = {});
+
+    // 上一次搜索得到的路径飞行时间（秒，不含代价层与升降惩罚）和扩展的节点数
+    double path_time() const { return _path_time; }
+    int64_t expanded_nodes() const { return _expanded_nodes; }
+
+    // 去掉路径中共线的中间点，只保留起点、拐点和终点（起点在前）
+    static std::vector<Grid3> corner_points(const std::vector<Grid3>& path);
+    // 在corner_points的基础上合并同一高度层上的拐点（起点在前）：从每个拐点直连最远的、
+    // checker判定可直线通行且代价（按find_path的边权）不高于原路径的拐点，升降处的拐点保持不变
+    // checker需设置与本对象相同的代价层
+    std::vector<Grid3> merge_corners(const std::vector<Grid3>& path,
+                                     const SegmentCollisionChecker& checker) const;
+
+   private:
+    bool in_range(const Grid3& cell) const;
+    // 在enter_time进入、arrive_time到达（相对departure的秒数）的cell是否被其他无人机预约
+    bool reserved(const Grid3& cell, float enter_time, float arrive_time) const;
+    // 到终点的飞行时间下界
+    double heuristic(int x, int y, int z, const Grid3& target) const;
+
+    const OccupancyGrid& _grid;
+    double _speed_h;
+    double _speed_v;
+    double _acc_h;
+    double _acc_v;
+    int _z_min;
+    int _z_max;
+    double _climb_penalty = 0;
+    const AStar::CostLayer* _cost_layer = nullptr;
+    Workspace* _workspace = nullptr;
+    Workspace _own_workspace;
+    const ReservationTable* _reservations = nullptr;
+    uint32_t _owner = 0;
+    int64_t _departure_ms = 0;
+    double _path_time = 0;
+    int64_t _expanded_nodes = 0;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef COLLISION_LAYER_H
+#define COLLISION_LAYER_H
+
+#include <vector>
+#include "AStar.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 占据网格每个z层的碰撞层，启动时计算一次，之后只读，供所有A*查询共享
+class CollisionLayerSet {
+   public:
+    void build(const OccupancyGrid& grid);
+
+    int layer_num() const { return _layers.size(); }
+    // 第z层的碰撞层，z越界时返回nullptr
+    const AStar::CollisionLayer* layer(int z) const {
+        return (z >= 0 && z < (int)_layers.size()) ? &_layers[z] : nullptr;
+    }
+
+   private:
+    std::vector<AStar::CollisionLayer> _layers;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
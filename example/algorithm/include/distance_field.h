@@ -0,0 +1,56 @@
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include <cstdint>
+#include <vector>
+#include "AStar.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 单源多目标的Dijkstra距离场
+// 在某一高度层上从源点向外扩展，得到源点到各目标cell的绕障最短距离（8邻域，直行10、对角14，
+// 与AStar::Generator的代价一致）。一次搜索即可得到代价矩阵中与该源点相关的一整行，
+// 所有目标的距离确定后即提前结束；由于地图无向，源点取起点或终点得到的距离相同
+// 内部数组按generation惰性重置，同一对象可连续为多个源点计算
+class DistanceField {
+   public:
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    // layer为grid某一高度的碰撞层（不拷贝），为nullptr时所有目标都不可达
+    DistanceField(const OccupancyGrid& grid, const AStar::CollisionLayer* layer);
+
+    // 以source为源点计算距离场，targets为需要的目标cell，为空时扩展整层
+    // 源点和目标所在cell被占据时仍视为可达（起降点可能紧贴建筑），但不会经过其他被占据的cell
+    void compute(AStar::Vec2i source, const AStar::CoordinateList& targets = {});
+
+    // 源点到cell的代价（直行一步为10），不可达、未确定或越界时返回UNREACHABLE
+    uint32_t cost(AStar::Vec2i cell) const;
+    // 源点到cell的距离（米），不可达时返回负值
+    double distance(AStar::Vec2i cell) const;
+    // 上一次计算确定距离的cell数
+    int64_t settled_cells() const { return _settled_cells; }
+
+   private:
+    bool in_range(AStar::Vec2i cell) const;
+    size_t index_of(AStar::Vec2i cell) const { return (size_t)cell.x * _size_y + cell.y; }
+    // 首次访问本次计算中的cell时重置其数据
+    void touch(size_t i);
+
+    const AStar::CollisionLayer* _layer;
+    int _size_x;
+    int _size_y;
+    float _cell_size;
+    std::vector<uint32_t> _cost;
+    std::vector<uint32_t> _stamp;
+    std::vector<uint8_t> _state;
+    // 循环桶队列，第i个桶存放代价模kBucketNum为i的待扩展cell（可能含过期项）
+    static const int kBucketNum = 15;
+    std::vector<uint32_t> _buckets[kBucketNum];
+    uint32_t _generation = 0;
+    int64_t _settled_cells = 0;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
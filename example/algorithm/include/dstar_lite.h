@@ -0,0 +1,88 @@
+#ifndef DSTAR_LITE_H
+#define DSTAR_LITE_H
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+#include "AStar.h"
+
+namespace mtuav::algorithm {
+
+// 单个高度层上的D* Lite增量规划器，用于悬停无人机的反复重规划
+// 从终点向起点反向搜索，g/rhs在多次find_path之间保留：起点移动时只累加km修正优先级，
+// 临时障碍（其他无人机近期的位置）变化时只更新变化cell的邻居，其余区域的结果直接复用
+// 邻域、边权（直行10、对角14，叠加代价层的附加代价）与AStar::Generator的8邻域A*一致，
+// 终点即使位于障碍内也可到达；设置ALT距离表时启发函数取对角距离与ALT下界的较大值
+class DStarLite {
+   public:
+    static constexpr uint32_t INF = 0xFFFFFFFF;
+
+    DStarLite() = default;
+
+    // 按碰撞层、代价层（可为nullptr）、终点与ALT距离表（可为nullptr，需由同一碰撞层计算）
+    // 重新初始化，之前的搜索状态全部丢弃；各层与距离表不拷贝，需在使用期间保持不变
+    void reset(const AStar::CollisionLayer* collision_layer, const AStar::CostLayer* cost_layer,
+               AStar::Vec2i goal, const AStar::LandmarkTable* landmarks = nullptr);
+    // 当前状态是否为这组参数建立，不是时需先reset
+    bool matches(const AStar::CollisionLayer* collision_layer, const AStar::CostLayer* cost_layer,
+                 AStar::Vec2i goal, const AStar::LandmarkTable* landmarks = nullptr) const;
+
+    // 以obstacles为临时障碍（不会阻塞起点和终点）规划从start到终点的逐格路径，
+    // 返回值与AStar::Generator::findPath一致（终点在前），不可达时返回空
+    AStar::CoordinateList find_path(AStar::Vec2i start, const AStar::CoordinateList& obstacles);
+
+    // 上一次find_path扩展的节点数与障碍发生变化的cell数
+    int expanded_nodes() const { return _expanded_nodes; }
+    int changed_cells() const { return _changed_cells; }
+
+   private:
+    struct Key {
+        uint32_t k1, k2;
+        bool operator<(const Key& other) const {
+            return k1 < other.k1 || (k1 == other.k1 && k2 < other.k2);
+        }
+    };
+    struct Entry {
+        Key key;
+        uint32_t cell;
+        bool operator>(const Entry& other) const { return other.key < key; }
+    };
+
+    size_t index(AStar::Vec2i c) const { return (size_t)c.x * _size.y + c.y; }
+    AStar::Vec2i coordinates(size_t i) const { return {(int)(i / _size.y), (int)(i % _size.y)}; }
+    // 沿第direction个方向进入相邻cell to的代价，不可进入时为INF
+    uint32_t edge_cost(AStar::Vec2i to, int direction) const;
+    // 同上，但不考虑to是否可进入
+    uint32_t step_cost(AStar::Vec2i to, int direction) const;
+    uint32_t heuristic(AStar::Vec2i a, AStar::Vec2i b) const;
+    Key calculate_key(size_t cell) const;
+    void update_vertex(size_t cell);
+    // 经过c的代价（进入c的边代价或g(c)）降低后，用c更新各前驱的rhs
+    void on_cost_decreased(AStar::Vec2i c);
+    // 经过c的代价升高后，只重新计算rhs原本经过c的前驱；old_g为升高前的g(c)，
+    // was_open表示进入c的边此前可通行（c刚被临时障碍占据）
+    void on_cost_increased(AStar::Vec2i c, uint32_t old_g, bool was_open);
+    void compute_shortest_path();
+    // 把临时障碍更新为obstacles，返回变化的cell数
+    int apply_obstacles(const AStar::CoordinateList& obstacles);
+
+    const AStar::CollisionLayer* _collision_layer = nullptr;
+    const AStar::CostLayer* _cost_layer = nullptr;
+    const AStar::LandmarkTable* _landmarks = nullptr;
+    AStar::Vec2i _size = {0, 0};
+    AStar::Vec2i _goal = {0, 0};
+    AStar::Vec2i _start = {0, 0};
+    AStar::Vec2i _last_start = {0, 0};
+    uint32_t _km = 0;
+    std::vector<uint32_t> _g, _rhs;
+    // 当前的临时障碍与唯一的开口（终点），用AStar::GridView判断可通行性
+    AStar::CollisionLayer _walls, _openings;
+    std::vector<uint32_t> _wall_cells;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> _open;
+    int _expanded_nodes = 0;
+    int _changed_cells = 0;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef ESDF_LAYER_H
+#define ESDF_LAYER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "grid_cache.h"
+#include "mtuav_sdk_map.h"
+#include "mtuav_sdk_types.h"
+
+namespace mtuav::algorithm {
+
+// 单一飞行高度上的二维距离层
+// 以resolution为间隔在(x, y)平面上采样Map::Query返回的Voxel::distance，连续存储为float数组，
+// 查询时做双线性插值，热路径上不再调用地图的虚函数Query
+// 地图外（Query返回nullptr）的采样点视为无障碍，记为kFreeDistance
+class EsdfLayer {
+   public:
+    static constexpr float kFreeDistance = 1e6f;
+
+    EsdfLayer() = default;
+    EsdfLayer(double altitude, float origin_x, float origin_y, float resolution, int size_x,
+              int size_y);
+
+    double altitude() const { return _altitude; }
+    int size_x() const { return _size_x; }
+    int size_y() const { return _size_y; }
+    float resolution() const { return _resolution; }
+
+    // 第(i, j)个采样点的距离
+    float at(int i, int j) const { return _distance[(size_t)i * _size_y + j]; }
+    float& at(int i, int j) { return _distance[(size_t)i * _size_y + j]; }
+    // 全部采样点的连续存储，用于读写缓存
+    float* data() { return _distance.data(); }
+    size_t data_bytes() const { return _distance.size() * sizeof(float); }
+    // 采样点(i, j)的世界坐标
+    double sample_x(int i) const { return _origin_x + i * _resolution; }
+    double sample_y(int j) const { return _origin_y + j * _resolution; }
+
+    // 双线性插值，超出范围的坐标裁剪到边界
+    float interpolate(double x, double y) const;
+    // 批量插值，输入为结构数组形式的坐标，循环内无分支，便于编译器向量化
+    void interpolate_batch(const float* xs, const float* ys, int n, float* out) const;
+
+   private:
+    double _altitude = 0;
+    float _origin_x = 0;
+    float _origin_y = 0;
+    float _resolution = 1;
+    float _inv_resolution = 1;
+    int _size_x = 0;
+    int _size_y = 0;
+    std::vector<float> _distance;
+};
+
+// 各候选巡航高度（与_altitude_drone_count对应的70~110m）的距离层缓存
+class EsdfLayerCache {
+   public:
+    // 对每个高度并行采样地图构建距离层
+    // cache不为nullptr时先按网格缓存的key读取各层，读取失败的层采样后写回
+    void build(std::shared_ptr<Map> map, const std::vector<double>& altitudes, float resolution,
+               const GridCache* cache = nullptr, uint64_t key = 0);
+
+    bool empty() const { return _layers.empty(); }
+    const std::vector<EsdfLayer>& layers() const { return _layers; }
+    // 与altitude相差不超过tolerance的最近距离层，不存在时返回nullptr
+    const EsdfLayer* layer(double altitude, double tolerance = 1.0) const;
+
+    // 查询p点的离障距离，p不在任一缓存高度上时返回false
+    bool clearance(const Vec3& p, float* distance) const;
+    // 轨迹上各点离障距离的最小值，跳过不在缓存高度上的点（如起降段），全部跳过时返回false
+    bool min_clearance(const std::vector<Segment>& segments, float* distance) const;
+
+   private:
+    std::vector<EsdfLayer> _layers;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef GRID_BUILDER_H
+#define GRID_BUILDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "mtuav_sdk_map.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 网格构建统计信息
+struct GridBuildStats {
+    int64_t query_count = 0;  // Map::Query调用次数
+    int64_t skipped_count = 0;  // 借助距离场直接推断、无需查询的cell数
+    int64_t tile_count = 0;   // tile数量
+    int64_t elapsed_ms = 0;   // 总耗时
+    int thread_num = 0;       // 实际使用的线程数
+};
+
+// 占据网格构建器
+// 将Map::Range给出的包围盒在x-y平面上切分为若干tile（每个tile包含完整的z列），
+// 由工作线程从任务队列中领取tile并调用Map::Query填充，构建耗时随核数线性下降
+// 开启距离场跳过后，利用Query返回的ESDF距离（1-Lipschitz）一次性推断以当前cell为球心的
+// 整个球内cell的占据状态，并用visited位图记录，空旷区域的Query次数可下降一个数量级
+class GridBuilder {
+   public:
+    GridBuilder(std::shared_ptr<Map> map, int cell_size_x, int cell_size_y, int cell_size_z);
+
+    // 设置工作线程数，<=0表示使用硬件并发数；设为1即退化为串行构建
+    void set_thread_num(int thread_num);
+    // 设置tile在x、y方向上包含的网格数
+    void set_tile_size(int tile_x, int tile_y);
+    // 是否利用ESDF距离跳过可推断的cell，默认开启
+    void set_distance_skipping(bool enable);
+
+    // 构建网格，网格原点为Map::Range给出的(min_x, min_y, min_z)
+    OccupancyGrid build();
+
+    const GridBuildStats& stats() const { return _stats; }
+
+   private:
+    struct Tile {
+        int x_begin, x_end;
+        int y_begin, y_end;
+    };
+
+    // 填充单个tile，返回Query调用次数
+    int64_t fill_tile(const Tile& tile, OccupancyGrid& grid, OccupancyGrid& visited);
+    // 将tile内以(x, y, z)为球心、半径radius（米）内的cell标记为已访问，occupied为其占据状态
+    // 返回新标记的cell数
+    int64_t mark_sphere(const Tile& tile, int x, int y, int z, float radius, bool occupied,
+                        OccupancyGrid& grid, OccupancyGrid& visited);
+    // 工作线程主循环
+    void worker(const std::vector<Tile>& tiles, OccupancyGrid& grid, OccupancyGrid& visited);
+
+    std::shared_ptr<Map> _map;
+    int _cell_size_x;
+    int _cell_size_y;
+    int _cell_size_z;
+    int _thread_num = 0;
+    int _tile_x = 32;
+    int _tile_y = 32;
+    bool _distance_skipping = true;
+
+    std::atomic<int> _next_tile{0};
+    std::atomic<int> _finished_tiles{0};
+    std::atomic<int64_t> _query_count{0};
+    std::atomic<int64_t> _skipped_count{0};
+    GridBuildStats _stats;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
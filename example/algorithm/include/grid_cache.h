@@ -0,0 +1,42 @@
+#ifndef GRID_CACHE_H
+#define GRID_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include "mtuav_sdk_map.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 占据网格的磁盘缓存
+// 缓存文件为带版本号的二进制文件：固定长度文件头 + OccupancyGrid的原始存储，
+// 文件头长度为cache line的整数倍，读取时直接mmap，网格数据零拷贝、无需解析
+// 缓存key由地图路径、地图文件大小与修改时间、地图元数据（包围盒、分辨率）以及cell大小共同决定
+class GridCache {
+   public:
+    explicit GridCache(std::string cache_dir = "./grid_cache");
+
+    // 生成缓存key；若地图文件同目录下存在meta_data.pb.txt，其包围盒与分辨率也参与计算
+    static uint64_t make_key(const std::string& map_path, Map* map, int cell_size_x,
+                             int cell_size_y, int cell_size_z);
+
+    // 缓存文件路径，suffix用于区分同一key下的不同数据
+    std::string cache_path(uint64_t key, const std::string& suffix = "grid") const;
+
+    // 以mmap方式加载缓存，key、版本或尺寸不匹配时返回false
+    bool load(uint64_t key, OccupancyGrid& grid) const;
+    // 写入缓存（先写临时文件再rename，避免其他进程读到不完整的文件）
+    bool save(uint64_t key, const OccupancyGrid& grid) const;
+
+    // 与网格同key的附加数据（如距离层、语义层），按suffix区分，文件头记录key与数据长度
+    // load_data读取恰好bytes字节到data，文件不存在或key、长度不匹配时返回false
+    bool load_data(uint64_t key, const std::string& suffix, void* data, size_t bytes) const;
+    bool save_data(uint64_t key, const std::string& suffix, const void* data, size_t bytes) const;
+
+   private:
+    std::string _cache_dir;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
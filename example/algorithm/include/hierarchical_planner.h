@@ -0,0 +1,61 @@
+#ifndef HIERARCHICAL_PLANNER_H
+#define HIERARCHICAL_PLANNER_H
+
+#include <vector>
+#include "AStar.h"
+#include "landmark_set.h"
+#include "occupancy_pyramid.h"
+
+namespace mtuav::algorithm {
+
+// 由粗到细的分层路径规划
+// 先在金字塔最粗层上搜索得到走廊，再逐层将走廊投影到下一层并膨胀，仅在走廊内搜索；
+// 走廊外的区域用一圈边界障碍封住，因此每层的搜索规模只与走廊大小有关
+// 任一层走廊内搜索失败时，该层退化为整层搜索
+class HierarchicalPlanner {
+   public:
+    explicit HierarchicalPlanner(const OccupancyPyramid& pyramid);
+
+    // 走廊膨胀半径（下一层的cell数）
+    void set_corridor_radius(int radius);
+    // 最细层使用的附加代价层（如语义代价），粗层只用于引导，不使用代价层
+    void set_cost_layer(const AStar::CostLayer* cost_layer);
+    // 最细层是否使用任意角度搜索（Theta*），开启后find_path返回拐点序列而非逐格路径；
+    // 不开启时，有临时障碍的最细层搜索使用双向A*
+    void set_any_angle(bool enable);
+    // 最细层使用的ALT距离表（不拷贝），对应高度层尚未计算完成时不使用
+    void set_landmarks(const LandmarkSet* landmarks);
+    // 各层搜索共用的搜索状态（不拷贝），用于在多次规划之间复用内存，nullptr表示每次新建
+    void set_workspace(AStar::SearchWorkspace* workspace);
+
+    // 在第layer层高度上规划路径，返回值与AStar::Generator::findPath一致（终点在前）
+    // extra_collisions为最细层上额外的临时障碍（如其他无人机的航线），不会阻塞起点和终点
+    AStar::CoordinateList find_path(AStar::Vec2i source, AStar::Vec2i target, int layer,
+                                    const AStar::CoordinateList& extra_collisions = {});
+
+    // 路径是否到达终点
+    static bool reached(const AStar::CoordinateList& path, AStar::Vec2i target);
+
+   private:
+    // 在第level层上搜索，boundary为走廊外紧邻走廊的一圈cell，作为障碍把搜索限制在走廊内，
+    // 为空表示不限制搜索范围
+    AStar::CoordinateList search(int level, AStar::Vec2i source, AStar::Vec2i target, int layer,
+                                 const AStar::CoordinateList& boundary,
+                                 const AStar::CoordinateList& extra_collisions);
+    // 按第level层的碰撞层、代价层与临时障碍配置generator（不含走廊）
+    void configure(AStar::Generator& generator, int level, int layer, AStar::Vec2i source,
+                   AStar::Vec2i target, const AStar::CoordinateList& extra_collisions);
+    // 将第level层的路径投影到第level-1层并膨胀为走廊，返回走廊的边界
+    AStar::CoordinateList make_corridor(int level, const AStar::CoordinateList& path);
+
+    const OccupancyPyramid& _pyramid;
+    int _corridor_radius = 2;
+    const AStar::CostLayer* _cost_layer = nullptr;
+    bool _any_angle = false;
+    AStar::SearchWorkspace* _workspace = nullptr;
+    const LandmarkSet* _landmarks = nullptr;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
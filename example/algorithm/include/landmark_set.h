@@ -0,0 +1,55 @@
+#ifndef LANDMARK_SET_H
+#define LANDMARK_SET_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "AStar.h"
+#include "grid_cache.h"
+#include "occupancy_pyramid.h"
+
+namespace mtuav::algorithm {
+
+// 各高度层的ALT landmark距离表，供AStar::Generator::setLandmarks与DStarLite使用
+// 每层用最远点采样选取landmark：第一个取距网格中心最远的可达cell，之后每次取到已选landmark
+// 最短距离最大的cell，使landmark分散在地图边缘与建筑群的两侧；距离表由DistanceField整层扩展得到
+// build_async在后台线程中逐层计算，某层完成前table返回nullptr，规划照常使用几何启发函数；
+// 提供GridCache时各层的landmark位置与距离表按网格缓存的key经GridCache::load_data读取，
+// 计算完成后用save_data写回
+class LandmarkSet {
+   public:
+    LandmarkSet() = default;
+    ~LandmarkSet();
+    LandmarkSet(const LandmarkSet&) = delete;
+    LandmarkSet& operator=(const LandmarkSet&) = delete;
+
+    // 为pyramid第0层的layers各高度层计算landmark_num个landmark的距离表；pyramid需在计算期间保持不变
+    // cache为nullptr时不读写缓存，key为网格缓存的key
+    void build_async(const OccupancyPyramid& pyramid, const std::vector<int>& layers,
+                     int landmark_num, const GridCache* cache = nullptr, uint64_t key = 0);
+    // 等待后台计算结束
+    void wait();
+
+    // 第z层的距离表，尚未计算完成或未计算该层时返回nullptr
+    const AStar::LandmarkTable* table(int z) const;
+
+   private:
+    void build_layer(const OccupancyPyramid& pyramid, int z, int landmark_num);
+    bool load(const OccupancyPyramid& pyramid, int z, int landmark_num);
+    void save(int z) const;
+
+    std::vector<AStar::LandmarkTable> _tables;
+    // 各层选取的landmark，按选取顺序存放，整层不可通行而未选满时以{-1, -1}补齐
+    std::vector<std::vector<AStar::Vec2i>> _landmarks;
+    std::unique_ptr<std::atomic<bool>[]> _ready;
+    std::unique_ptr<GridCache> _cache;
+    uint64_t _key = 0;
+    std::atomic<bool> _stop{false};
+    std::thread _worker;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "mtuav_sdk_types.h"
+
+namespace mtuav::algorithm {
+
+// 三维占据网格，每个cell占1 bit
+// 存储布局：按(x, y)行优先排列z列，每个z列占words_per_column()个uint64_t，
+// 列长度向上取整到2的幂（最多8个word），整体按64字节对齐，保证单个z列不会跨cache line
+// 世界坐标与网格坐标的换算以Map::Range给出的(min_x, min_y, min_z)为原点
+class OccupancyGrid {
+   public:
+    OccupancyGrid() = default;
+    OccupancyGrid(int size_x, int size_y, int size_z, float origin_x, float origin_y,
+                  float origin_z, float cell_size_x, float cell_size_y, float cell_size_z);
+    // 使用外部存储构造（如mmap映射的缓存文件），storage需按本类布局存放且64字节对齐
+    OccupancyGrid(int size_x, int size_y, int size_z, float origin_x, float origin_y,
+                  float origin_z, float cell_size_x, float cell_size_y, float cell_size_z,
+                  std::shared_ptr<uint64_t> storage);
+    OccupancyGrid(const OccupancyGrid&) = delete;
+    OccupancyGrid& operator=(const OccupancyGrid&) = delete;
+    OccupancyGrid(OccupancyGrid&&) = default;
+    OccupancyGrid& operator=(OccupancyGrid&&) = default;
+
+    bool empty() const { return _bits == nullptr; }
+    int size_x() const { return _size_x; }
+    int size_y() const { return _size_y; }
+    int size_z() const { return _size_z; }
+    float origin_x() const { return _origin_x; }
+    float origin_y() const { return _origin_y; }
+    float origin_z() const { return _origin_z; }
+    float cell_size_x() const { return _cell_size_x; }
+    float cell_size_y() const { return _cell_size_y; }
+    float cell_size_z() const { return _cell_size_z; }
+
+    bool in_bounds(int x, int y, int z) const {
+        return x >= 0 && x < _size_x && y >= 0 && y < _size_y && z >= 0 && z < _size_z;
+    }
+
+    // 查询cell是否被占据，越界视为占据
+    bool occupied(int x, int y, int z) const {
+        if (!in_bounds(x, y, z)) {
+            return true;
+        }
+        return (column(x, y)[z >> 6] >> (z & 63)) & 1;
+    }
+    // 不做越界检查的版本，调用方保证坐标合法
+    bool occupied_unchecked(int x, int y, int z) const {
+        return (column(x, y)[z >> 6] >> (z & 63)) & 1;
+    }
+    void set(int x, int y, int z, bool occupied) {
+        uint64_t& word = _bits[column_offset(x, y) + (z >> 6)];
+        uint64_t mask = uint64_t(1) << (z & 63);
+        word = occupied ? (word | mask) : (word & ~mask);
+    }
+
+    // 获取(x, y)处完整的z列，第z位表示第z层是否占据
+    const uint64_t* column(int x, int y) const { return _bits + column_offset(x, y); }
+    uint64_t* column(int x, int y) { return _bits + column_offset(x, y); }
+    int words_per_column() const { return _words_per_column; }
+
+    // 第z层(x, y)周围8邻域的占据情况，第i位对应neighbor_offsets()[i]，越界视为占据
+    uint8_t neighbors8(int x, int y, int z) const;
+    // 8邻域偏移：前4个为上下左右，后4个为对角，与AStar::Generator的方向顺序一致
+    static const Grid3* neighbor_offsets();
+
+    // 世界坐标 -> 网格坐标（向下取整，不做越界裁剪）
+    int world_to_cell_x(double x) const { return (int)std::floor((x - _origin_x) / _cell_size_x); }
+    int world_to_cell_y(double y) const { return (int)std::floor((y - _origin_y) / _cell_size_y); }
+    int world_to_cell_z(double z) const { return (int)std::floor((z - _origin_z) / _cell_size_z); }
+    Grid3 world_to_cell(const Vec3& p) const {
+        return {world_to_cell_x(p.x), world_to_cell_y(p.y), world_to_cell_z(p.z)};
+    }
+    // 网格坐标 -> cell中心的世界坐标
+    double cell_center_x(int x) const { return _origin_x + (x + 0.5) * _cell_size_x; }
+    double cell_center_y(int y) const { return _origin_y + (y + 0.5) * _cell_size_y; }
+    double cell_center_z(int z) const { return _origin_z + (z + 0.5) * _cell_size_z; }
+    Vec3 cell_center(int x, int y, int z) const {
+        return {cell_center_x(x), cell_center_y(y), cell_center_z(z)};
+    }
+
+    // 统计占据的cell数量
+    int64_t count_occupied() const;
+    // 占用的存储字节数
+    size_t memory_bytes() const { return word_count() * sizeof(uint64_t); }
+    size_t word_count() const { return (size_t)_size_x * _size_y * _words_per_column; }
+    const uint64_t* data() const { return _bits; }
+    uint64_t* data() { return _bits; }
+
+    // 给定z方向cell数时每个z列占用的word数
+    static int column_words(int size_z);
+
+   private:
+    size_t column_offset(int x, int y) const {
+        return ((size_t)x * _size_y + y) * _words_per_column;
+    }
+
+    int _size_x = 0;
+    int _size_y = 0;
+    int _size_z = 0;
+    int _words_per_column = 0;
+    float _origin_x = 0;
+    float _origin_y = 0;
+    float _origin_z = 0;
+    float _cell_size_x = 1;
+    float _cell_size_y = 1;
+    float _cell_size_z = 1;
+    std::shared_ptr<uint64_t> _storage;  // 持有存储
+    uint64_t* _bits = nullptr;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef OCCUPANCY_PYRAMID_H
+#define OCCUPANCY_PYRAMID_H
+
+#include <vector>
+#include "collision_layer.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 多分辨率占据金字塔
+// 第0层即原始网格（不持有），第l层在x、y方向上的cell大小为原始网格的2^l倍，z方向分辨率不变，
+// 便于在同一飞行高度层上做由粗到细的搜索。粗层cell只要覆盖的任一细层cell被占据即视为占据，
+// 因此粗层上无障碍的区域在细层上必然无障碍
+// 构建时同时为每一层的每个高度预计算碰撞层，A*查询直接引用，无需逐cell添加障碍
+class OccupancyPyramid {
+   public:
+    OccupancyPyramid() = default;
+
+    // 由原始网格逐层2x2合并构建，level_num包含第0层，例如10m网格取4层得到10/20/40/80m
+    void build(const OccupancyGrid& base, int level_num);
+
+    bool empty() const { return _base == nullptr; }
+    int level_num() const { return _levels.size() + (_base == nullptr ? 0 : 1); }
+    const OccupancyGrid& level(int l) const { return l == 0 ? *_base : _levels[l - 1]; }
+    // 第l层第z个高度的碰撞层，z越界时返回nullptr
+    const AStar::CollisionLayer* collision_layer(int l, int z) const {
+        return _collision_layers[l].layer(z);
+    }
+
+   private:
+    const OccupancyGrid* _base = nullptr;
+    std::vector<OccupancyGrid> _levels;
+    std::vector<CollisionLayerSet> _collision_layers;  // 包含第0层
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
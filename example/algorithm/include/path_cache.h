@@ -0,0 +1,59 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "mtuav_sdk_types.h"
+
+namespace mtuav::algorithm {
+
+// 规划结果的LRU缓存
+// 以起点cell、终点cell（均含高度层）为key，缓存化简后的拐点序列（起点在前）；
+// 无人机反复往返于相同的取货点、换电站和降落点，重复的路线可直接从缓存取出，不必重新搜索
+// 规划结果依赖的静态层（占据网格、语义代价层等）变化时需调用invalidate清空缓存；
+// 带临时障碍（如其他无人机航线）的查询结果每次都不同，不应写入缓存
+class PathCache {
+   public:
+    explicit PathCache(size_t capacity = 512);
+
+    // 命中时将路径拷贝到path并返回true，同时把该项移到最近使用的位置
+    bool lookup(const Grid3& start, const Grid3& goal, std::vector<Grid3>& path);
+    // 写入路径，已存在时覆盖；超出容量时淘汰最久未使用的项
+    void insert(const Grid3& start, const Grid3& goal, std::vector<Grid3> path);
+    // 删除当前所有缓存项，命中统计保留
+    void invalidate();
+
+    size_t size() const { return _index.size(); }
+    uint64_t hits() const { return _hits; }
+    uint64_t misses() const { return _misses; }
+    // 命中率，尚无查询时为0
+    double hit_rate() const;
+
+   private:
+    struct Key {
+        Grid3 start;
+        Grid3 goal;
+        bool operator==(const Key& other) const;
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        std::vector<Grid3> path;
+    };
+
+    size_t _capacity;
+    uint64_t _hits = 0;
+    uint64_t _misses = 0;
+    // 表头为最近使用的项
+    std::list<Entry> _entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> _index;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
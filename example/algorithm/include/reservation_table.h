@@ -0,0 +1,54 @@
+#ifndef RESERVATION_TABLE_H
+#define RESERVATION_TABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "mtuav_sdk_types.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 多机航线的时空预约表，以(cell, 时间桶)为key记录已发布轨迹占用的空间
+// 轨迹按不超过半个cell、半个时间桶的间隔插值采样，每个采样点连同周围一圈cell
+// （水平与上下各1个cell，覆盖20m的悬停判定距离）预约到所在的时间桶；
+// 查询时同时检查前后相邻的时间桶，容忍规划时估计的到达时间与实际轨迹之间的误差
+// 时间均为毫秒级的绝对时间戳
+class ReservationTable {
+   public:
+    explicit ReservationTable(int64_t bucket_ms = 2000);
+
+    // 清空预约，并按grid划分cell（不拷贝，grid需在使用期间保持不变）
+    void reset(const OccupancyGrid& grid);
+    bool empty() const { return _cells.empty(); }
+    size_t size() const { return _cells.size(); }
+
+    // 无人机id对应的预约者编号
+    static uint32_t owner_id(const std::string& drone_id);
+    // 预约一条在takeoff_ms起飞的轨迹，只预约from_ms之后的部分
+    void reserve(uint32_t owner, const std::vector<Segment>& segs, int64_t takeoff_ms,
+                 int64_t from_ms = 0);
+    // cell在time_ms附近是否被owner以外的轨迹预约
+    bool conflicts(const Grid3& cell, int64_t time_ms, uint32_t owner) const;
+    // 在takeoff_ms起飞的轨迹上与其他轨迹冲突的采样点数
+    int count_conflicts(const std::vector<Segment>& segs, int64_t takeoff_ms,
+                        uint32_t owner) const;
+
+   private:
+    static const uint32_t kShared = 0;  // 同一key被多条轨迹预约
+
+    // 按采样间隔遍历轨迹，对每个采样点调用visit(cell, 绝对时间)
+    void sample(const std::vector<Segment>& segs, int64_t takeoff_ms,
+                const std::function<void(const Grid3&, int64_t)>& visit) const;
+    uint64_t key(int x, int y, int z, int64_t bucket) const;
+
+    int64_t _bucket_ms;
+    const OccupancyGrid* _grid = nullptr;
+    std::unordered_map<uint64_t, uint32_t> _cells;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
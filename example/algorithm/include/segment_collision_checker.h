@@ -0,0 +1,63 @@
+#ifndef SEGMENT_COLLISION_CHECKER_H
+#define SEGMENT_COLLISION_CHECKER_H
+
+#include <cstdint>
+#include <vector>
+#include "AStar.h"
+#include "esdf_layer.h"
+#include "mtuav_sdk_types.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 三维线段
+struct LineSegment {
+    Vec3 from;
+    Vec3 to;
+};
+
+// 线段检测结果
+struct SegmentHit {
+    bool blocked = false;
+    Vec3 hit_point = {0, 0, 0};  // 第一个碰撞点（进入第一个被占据cell的位置）
+    Grid3 hit_cell = {0, 0, 0};  // 第一个被占据的cell
+};
+
+// 批量线段碰撞检测
+// 默认在占据网格上用3D DDA（Amanatides-Woo）遍历线段经过的所有cell，
+// 线段恰好穿过cell棱角时同时检查相邻的cell，结果偏保守；离开地图范围视为碰撞
+// 若设置了距离层，落在缓存高度上的水平线段改用ESDF球追踪，按离障距离大步前进
+class SegmentCollisionChecker {
+   public:
+    explicit SegmentCollisionChecker(const OccupancyGrid& grid);
+
+    // 设置距离层及球追踪的安全距离（米），离障距离小于安全距离即视为碰撞；
+    // safe_distance需大于0，否则不使用距离层
+    void set_esdf_layers(const EsdfLayerCache* esdf_layers, float safe_distance);
+    // 附加代价层（尺寸与grid的x、y一致），line_of_sight把其中BLOCKED的cell视为障碍，nullptr表示不使用
+    void set_cost_layer(const AStar::CostLayer* cost_layer);
+
+    // 批量检测，results与segments一一对应
+    void check(const std::vector<LineSegment>& segments, std::vector<SegmentHit>& results) const;
+    // 检测单条线段
+    SegmentHit check(const LineSegment& segment) const;
+    // 线段是否无碰撞
+    bool is_free(const Vec3& from, const Vec3& to) const;
+    // 第layer层上两个cell中心之间是否可以直线通行，与AStar::Generator的Theta*使用同一种supercover检查
+    // extra_cost、cell_count不为nullptr时返回沿途经过的cell（不含起点）的附加代价之和与cell数
+    bool line_of_sight(int x0, int y0, int x1, int y1, int layer, uint32_t* extra_cost = nullptr,
+                       int* cell_count = nullptr) const;
+
+   private:
+    SegmentHit traverse_grid(const LineSegment& segment) const;
+    SegmentHit sphere_trace(const LineSegment& segment, const EsdfLayer& layer) const;
+
+    const OccupancyGrid& _grid;
+    const EsdfLayerCache* _esdf_layers = nullptr;
+    const AStar::CostLayer* _cost_layer = nullptr;
+    float _safe_distance = 0;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
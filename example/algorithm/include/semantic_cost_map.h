@@ -0,0 +1,43 @@
+#ifndef SEMANTIC_COST_MAP_H
+#define SEMANTIC_COST_MAP_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "AStar.h"
+#include "grid_cache.h"
+#include "mtuav_sdk_map.h"
+#include "occupancy_grid.h"
+
+namespace mtuav::algorithm {
+
+// 由Voxel::semantic构建的2.5D语义代价层
+// 空中位置的semantic表示其正下方地图实体的语义，因此每个(x, y)列只需在网格顶层查询一次，
+// 按语义映射为A*的附加代价：危险区域禁止通行，道路上空不加代价，其余区域适当加代价，
+// 规划时A*直接读取该层作为边权，不再调用Map::Query
+class SemanticCostMap {
+   public:
+    SemanticCostMap();
+
+    // 设置某种语义的附加代价（直行一步的基础代价为10），AStar::CostLayer::BLOCKED表示禁止通行
+    void set_semantic_cost(BlockSemantic semantic, uint8_t cost);
+    // 按grid的x、y划分构建代价层
+    // cache不为nullptr时各列的语义按网格缓存的key读写，命中时不再查询地图
+    void build(std::shared_ptr<Map> map, const OccupancyGrid& grid,
+               const GridCache* cache = nullptr, uint64_t key = 0);
+
+    bool empty() const { return _layer.getSize().x == 0; }
+    const AStar::CostLayer& layer() const { return _layer; }
+
+   private:
+    uint8_t semantic_cost(uint8_t semantic) const;
+
+    std::map<uint8_t, uint8_t> _semantic_costs;
+    uint8_t _default_cost = 2;  // 未知语义
+    AStar::CostLayer _layer;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SYNTHETIC_MAP_H
+#define SYNTHETIC_MAP_H
+
+#include <cstdint>
+#include <vector>
+#include "mtuav_sdk_map.h"
+
+namespace mtuav::algorithm {
+
+// 合成地图参数，单位均为米
+struct SyntheticMapConfig {
+    float size_x = 3000;
+    float size_y = 3000;
+    float min_z = -40;   // 地面(z=0)以下的范围，与真实地图一致
+    float max_z = 260;
+    float block_size = 150;  // 街区间距（含道路）
+    float road_width = 20;   // 街区之间的道路宽度
+    int lots_per_side = 2;   // 每个街区在x、y方向上划分的地块数
+    float building_density = 0.6;  // 地块建房概率
+    float min_building_height = 20;
+    float max_building_height = 180;
+    float park_ratio = 0.15;       // 街区为绿地（无房屋）的概率
+    float dangerous_ratio = 0.03;  // 街区为危险区域的概率
+    float dangerous_height = 150;  // 危险区域的高度
+    uint32_t seed = 1;
+};
+
+// 程序化生成的城市地图，不依赖地图文件，用于离线测试网格构建与路径规划的性能
+// 地图由z=0的地面、纵横的道路和道路之间的街区组成，街区内按地块随机生成不同高度的长方体房屋，
+// 部分街区为绿地或危险区域；相同参数（包括seed）在任何机器上生成完全相同的地图
+// Query返回各实体有向距离的最小值，地图外部返回nullptr；每个线程使用独立的返回值，可并发查询
+class SyntheticMap : public Map {
+   public:
+    explicit SyntheticMap(const SyntheticMapConfig& config = SyntheticMapConfig());
+
+    void Range(float* min_x, float* max_x, float* min_y, float* max_y, float* min_z,
+               float* max_z) override;
+    const Voxel* Query(float x, float y, float z) override;
+
+    const SyntheticMapConfig& config() const { return _config; }
+    int building_count() const { return _building_count; }
+    int dangerous_count() const { return _dangerous_count; }
+
+   private:
+    // 从地面向上延伸到max_z的长方体
+    struct Box {
+        float min_x, max_x;
+        float min_y, max_y;
+        float max_z;
+        uint8_t semantic;
+    };
+
+    void generate();
+    // 长方体的有向距离，内部为负
+    static float box_distance(const Box& box, float x, float y, float z);
+    // (x, y)处地面的语义
+    uint8_t ground_semantic(float x, float y, int block_x, int block_y) const;
+    int block_index(int block_x, int block_y) const { return block_x * _block_num_y + block_y; }
+
+    SyntheticMapConfig _config;
+    int _block_num_x = 0;
+    int _block_num_y = 0;
+    std::vector<Box> _boxes;
+    // 第i个街区的长方体为_boxes[_block_begin[i], _block_begin[i + 1])
+    std::vector<int> _block_begin;
+    std::vector<uint8_t> _block_semantic;  // 街区内空地的语义
+    int _building_count = 0;
+    int _dangerous_count = 0;
+};
+
+}  // namespace mtuav::algorithm
+
+#endif
@@ -1,28 +1,149 @@
 #include "AStar.h"
 #include <algorithm>
 #include <math.h>
+#include "AStarEngine.h"
 
-using namespace std::placeholders;
+namespace
+{
+    // 按代价层、邻域逐级选择SearchEngine的实例，每种组合在此处实例化一次
+    template <class HeuristicT, class NeighborhoodT>
+    AStar::CoordinateList searchWithCost(const AStar::GridView& grid_, HeuristicT heuristic_,
+                                         AStar::Vec2i source_, AStar::Vec2i target_,
+                                         AStar::SearchWorkspace& workspace_,
+                                         AStar::uint& expandedNodes_)
+    {
+        AStar::CoordinateList path;
+        if (grid_.costLayer != nullptr) {
+            AStar::SearchEngine<HeuristicT, NeighborhoodT, AStar::policy::LayerCost> engine(
+                grid_, heuristic_);
+            path = engine.findPath(source_, target_, workspace_);
+            expandedNodes_ = engine.getExpandedNodes();
+        }
+        else {
+            AStar::SearchEngine<HeuristicT, NeighborhoodT, AStar::policy::UniformCost> engine(
+                grid_, heuristic_);
+            path = engine.findPath(source_, target_, workspace_);
+            expandedNodes_ = engine.getExpandedNodes();
+        }
+        return path;
+    }
+
+    template <class HeuristicT>
+    AStar::CoordinateList searchWithHeuristic(const AStar::GridView& grid_, HeuristicT heuristic_,
+                                              bool diagonal_, AStar::Vec2i source_,
+                                              AStar::Vec2i target_,
+                                              AStar::SearchWorkspace& workspace_,
+                                              AStar::uint& expandedNodes_)
+    {
+        if (diagonal_) {
+            return searchWithCost<HeuristicT, AStar::policy::EightConnected>(
+                grid_, heuristic_, source_, target_, workspace_, expandedNodes_);
+        }
+        return searchWithCost<HeuristicT, AStar::policy::FourConnected>(
+            grid_, heuristic_, source_, target_, workspace_, expandedNodes_);
+    }
+}
 
 bool AStar::Vec2i::operator == (const Vec2i& coordinates_)
 {
     return (x == coordinates_.x && y == coordinates_.y);
 }
 
-AStar::Node::Node(Vec2i coordinates_, Node *parent_)
+AStar::CollisionLayer::CollisionLayer(Vec2i size_)
+{
+    size = size_;
+    bits.assign((static_cast<std::size_t>(size.x) * size.y + 63) / 64, 0);
+}
+
+void AStar::CollisionLayer::clear()
+{
+    std::fill(bits.begin(), bits.end(), 0);
+}
+
+AStar::uint AStar::CollisionLayer::count() const
+{
+    uint total = 0;
+    for (auto word : bits) {
+        total += __builtin_popcountll(word);
+    }
+    return total;
+}
+
+AStar::CostLayer::CostLayer(Vec2i size_)
+{
+    size = size_;
+    costs.assign(static_cast<std::size_t>(size.x) * size.y, 0);
+}
+
+AStar::CoordinateList AStar::CostLayer::blockedRegion(Vec2i seed_) const
+{
+    CoordinateList region;
+    if (seed_.x < 0 || seed_.x >= size.x || seed_.y < 0 || seed_.y >= size.y ||
+        getCost(seed_) != BLOCKED) {
+        return region;
+    }
+    std::vector<bool> visited(costs.size(), false);
+    visited[static_cast<std::size_t>(seed_.x) * size.y + seed_.y] = true;
+    region.push_back(seed_);
+    for (std::size_t i = 0; i < region.size(); ++i) {
+        Vec2i current = region[i];
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                Vec2i next = { current.x + dx, current.y + dy };
+                if (next.x < 0 || next.x >= size.x || next.y < 0 || next.y >= size.y) {
+                    continue;
+                }
+                std::size_t index = static_cast<std::size_t>(next.x) * size.y + next.y;
+                if (!visited[index] && costs[index] == BLOCKED) {
+                    visited[index] = true;
+                    region.push_back(next);
+                }
+            }
+        }
+    }
+    return region;
+}
+
+AStar::LandmarkTable::LandmarkTable(Vec2i size_, uint count_)
+{
+    size = size_;
+    count = count_;
+    distances.assign(static_cast<std::size_t>(size.x) * size.y * count, UNREACHABLE);
+}
+
+AStar::SearchWorkspace::SearchWorkspace()
 {
-    parent = parent_;
-    coordinates = coordinates_;
-    G = H = 0;
+    generation = 0;
 }
 
-AStar::uint AStar::Node::getScore()
+void AStar::SearchWorkspace::reset(Vec2i worldSize_, uint planes_)
 {
-    return G + H;
+    std::size_t cellCount = static_cast<std::size_t>(worldSize_.x) * worldSize_.y * planes_;
+    if (cellCount > stamps.size()) {
+        nodeIndex.resize(cellCount);
+        stamps.resize(cellCount, 0);
+    }
+    if (++generation == 0) {
+        // 计数器回绕时才真正清空
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+    nodes.clear();
+    openList.clear();
+    reverseOpenList.clear();
 }
 
 AStar::Generator::Generator()
 {
+    collisionLayer = nullptr;
+    costLayer = nullptr;
+    landmarks = nullptr;
+    worldSize = { 0, 0 };
+    jumpPointSearch = false;
+    anyAngle = false;
+    bidirectional = false;
+    workspace = nullptr;
+    expandedNodes = 0;
     setDiagonalMovement(false);
     setHeuristic(&Heuristic::manhattan);
     direction = {
@@ -34,6 +155,8 @@ AStar::Generator::Generator()
 void AStar::Generator::setWorldSize(Vec2i worldSize_)
 {
     worldSize = worldSize_;
+    walls = CollisionLayer(worldSize_);
+    openings = CollisionLayer(worldSize_);
 }
 
 void AStar::Generator::setDiagonalMovement(bool enable_)
@@ -43,136 +166,612 @@ void AStar::Generator::setDiagonalMovement(bool enable_)
 
 void AStar::Generator::setHeuristic(HeuristicFunction heuristic_)
 {
-    heuristic = std::bind(heuristic_, _1, _2);
+    heuristic = heuristic_;
+    heuristicKind = HeuristicKind::custom;
+    auto function = heuristic_.target<uint (*)(Vec2i, Vec2i)>();
+    if (function != nullptr) {
+        if (*function == &Heuristic::manhattan) {
+            heuristicKind = HeuristicKind::manhattan;
+        }
+        else if (*function == &Heuristic::euclidean) {
+            heuristicKind = HeuristicKind::euclidean;
+        }
+        else if (*function == &Heuristic::octagonal) {
+            heuristicKind = HeuristicKind::octagonal;
+        }
+    }
+}
+
+void AStar::Generator::setJumpPointSearch(bool enable_)
+{
+    jumpPointSearch = enable_;
+}
+
+void AStar::Generator::setAnyAngle(bool enable_)
+{
+    anyAngle = enable_;
+}
+
+void AStar::Generator::setBidirectional(bool enable_)
+{
+    bidirectional = enable_;
+}
+
+void AStar::Generator::setCollisionLayer(const CollisionLayer* layer_)
+{
+    collisionLayer = layer_;
+}
+
+void AStar::Generator::setCostLayer(const CostLayer* layer_)
+{
+    costLayer = layer_;
+}
+
+void AStar::Generator::setLandmarks(const LandmarkTable* landmarks_)
+{
+    landmarks = landmarks_;
+}
+
+void AStar::Generator::setWorkspace(SearchWorkspace* workspace_)
+{
+    workspace = workspace_;
+}
+
+AStar::SearchWorkspace& AStar::Generator::activeWorkspace()
+{
+    return workspace != nullptr ? *workspace : ownWorkspace;
 }
 
 void AStar::Generator::addCollision(Vec2i coordinates_)
 {
-    walls.push_back(coordinates_);
+    if (isInside(coordinates_)) {
+        walls.set(coordinates_);
+    }
 }
 
 void AStar::Generator::removeCollision(Vec2i coordinates_)
 {
-    auto it = std::find(walls.begin(), walls.end(), coordinates_);
-    if (it != walls.end()) {
-        walls.erase(it);
+    if (isInside(coordinates_)) {
+        walls.reset(coordinates_);
+        // 碰撞层和代价层只读，记录为例外
+        openings.set(coordinates_);
     }
 }
 
 void AStar::Generator::clearCollisions()
 {
     walls.clear();
+    openings.clear();
 }
 
 AStar::CoordinateList AStar::Generator::findPath(Vec2i source_, Vec2i target_)
 {
-    Node *current = nullptr;
-    NodeSet openSet, closedSet;
-    openSet.reserve(100);
-    closedSet.reserve(100);
-    openSet.push_back(new Node(source_));
+    expandedNodes = 0;
+    if (!isInside(source_)) {
+        return{ source_ };
+    }
+    if (jumpPointSearch && !anyAngle && directions == 8 && costLayer == nullptr) {
+        return findPathJPS(source_, target_);
+    }
+    if (bidirectional && !anyAngle) {
+        return findPathBidirectional(source_, target_);
+    }
+    if (!anyAngle) {
+        return findPathEngine(source_, target_);
+    }
 
-    while (!openSet.empty()) {
-        auto current_it = openSet.begin();
-        current = *current_it;
+    // 每个cell至多对应一个节点，按x * worldSize.y + y索引，open/closed判断为O(1)
+    SearchWorkspace& ws = activeWorkspace();
+    ws.reset(worldSize);
+    NodeSet& nodes = ws.nodes;
+    OpenList& openList = ws.openList;
+    uint current = ws.addNode(source_, Node::NONE, 0, estimate(source_, target_));
+    ws.assign(cellIndex(source_), current);
+    openList.push(current, nodes[current].getScore(), nodes[current].H);
 
-        for (auto it = openSet.begin(); it != openSet.end(); it++) {
-            auto node = *it;
-            if (node->getScore() <= current->getScore()) {
-                current = node;
-                current_it = it;
-            }
+    while (!openList.empty()) {
+        uint node = openList.pop();
+        if (nodes[node].closed) {
+            continue;  // 节点重新入堆后留下的旧项
         }
+        current = node;
 
-        if (current->coordinates == target_) {
+        if (nodes[current].coordinates == target_) {
             break;
         }
 
-        closedSet.push_back(current);
-        openSet.erase(current_it);
+        nodes[current].closed = true;
+        ++expandedNodes;
 
+        // nodes在循环中可能扩容，只保存值而不保存引用
+        Vec2i currentCoordinates = nodes[current].coordinates;
+        uint currentG = nodes[current].G;
+        uint currentParent = nodes[current].parent;
         for (uint i = 0; i < directions; ++i) {
-            Vec2i newCoordinates(current->coordinates + direction[i]);
-            if (detectCollision(newCoordinates) ||
-                findNodeOnList(closedSet, newCoordinates)) {
+            Vec2i newCoordinates(currentCoordinates + direction[i]);
+            if (detectCollision(newCoordinates)) {
+                continue;
+            }
+            std::size_t cell = cellIndex(newCoordinates);
+            uint successor = ws.find(cell);
+            if (successor != Node::NONE && nodes[successor].closed) {
                 continue;
             }
 
-            uint totalCost = current->G + ((i < 4) ? 10 : 14);
+            uint extra = 0;
+            if (costLayer != nullptr &&
+                costLayer->getCost(newCoordinates) != CostLayer::BLOCKED) {
+                extra = costLayer->getCost(newCoordinates);
+            }
+            // Theta*：单步与直线段使用同一种代价，父节点与后继之间直线可通行时直接相连
+            // 单步也做直线检查，对角移动不能擦过障碍的棱角，保证输出的每一段都可直线通行
+            uint stepExtra, stepCells;
+            if (i >= 4 &&
+                !lineOfSight(currentCoordinates, newCoordinates, stepExtra, stepCells)) {
+                continue;
+            }
+            uint from = current;
+            uint totalCost = currentG + legCost(currentCoordinates, newCoordinates, extra, 1);
+            uint legExtra, legCells;
+            Vec2i parentCoordinates = (currentParent != Node::NONE) ?
+                nodes[currentParent].coordinates : currentCoordinates;
+            if (currentParent != Node::NONE &&
+                lineOfSight(parentCoordinates, newCoordinates, legExtra, legCells)) {
+                uint legTotal = nodes[currentParent].G +
+                    legCost(parentCoordinates, newCoordinates, legExtra, legCells);
+                if (legTotal <= totalCost) {
+                    from = currentParent;
+                    totalCost = legTotal;
+                }
+            }
 
-            Node *successor = findNodeOnList(openSet, newCoordinates);
-            if (successor == nullptr) {
-                successor = new Node(newCoordinates, current);
-                successor->G = totalCost;
-                successor->H = heuristic(successor->coordinates, target_);
-                openSet.push_back(successor);
+            if (successor == Node::NONE) {
+                successor = ws.addNode(newCoordinates, from, totalCost,
+                                       estimate(newCoordinates, target_));
+                ws.assign(cell, successor);
+                openList.push(successor, nodes[successor].getScore(), nodes[successor].H);
             }
-            else if (totalCost < successor->G) {
-                successor->parent = current;
-                successor->G = totalCost;
+            else if (totalCost < nodes[successor].G) {
+                nodes[successor].parent = from;
+                nodes[successor].G = totalCost;
+                openList.push(successor, nodes[successor].getScore(), nodes[successor].H);
             }
         }
     }
 
     CoordinateList path;
-    while (current != nullptr) {
-        path.push_back(current->coordinates);
-        current = current->parent;
+    for (uint node = current; node != Node::NONE; node = nodes[node].parent) {
+        path.push_back(nodes[node].coordinates);
+    }
+
+    return path;
+}
+
+AStar::CoordinateList AStar::Generator::findPathEngine(Vec2i source_, Vec2i target_)
+{
+    // 按当前设置分派到编译期组合的SearchEngine，搜索循环中没有间接调用
+    GridView grid = gridView();
+    SearchWorkspace& ws = activeWorkspace();
+    bool diagonal = directions == 8;
+    if (landmarks != nullptr) {
+        return searchWithHeuristic(grid, policy::Landmark<policy::Octagonal>{ landmarks, {} },
+                                   diagonal, source_, target_, ws, expandedNodes);
+    }
+    switch (heuristicKind) {
+    case HeuristicKind::manhattan:
+        return searchWithHeuristic(grid, policy::Manhattan(), diagonal, source_, target_, ws,
+                                   expandedNodes);
+    case HeuristicKind::euclidean:
+        return searchWithHeuristic(grid, policy::Euclidean(), diagonal, source_, target_, ws,
+                                   expandedNodes);
+    case HeuristicKind::octagonal:
+        return searchWithHeuristic(grid, policy::Octagonal(), diagonal, source_, target_, ws,
+                                   expandedNodes);
+    default:
+        return searchWithHeuristic(grid, policy::Function{ &heuristic }, diagonal, source_,
+                                   target_, ws, expandedNodes);
+    }
+}
+
+AStar::uint AStar::Generator::estimate(Vec2i coordinates_, Vec2i goal_)
+{
+    if (landmarks == nullptr) {
+        switch (heuristicKind) {
+        case HeuristicKind::manhattan:
+            return policy::Manhattan()(coordinates_, goal_);
+        case HeuristicKind::euclidean:
+            return policy::Euclidean()(coordinates_, goal_);
+        case HeuristicKind::octagonal:
+            return policy::Octagonal()(coordinates_, goal_);
+        default:
+            return heuristic(coordinates_, goal_);
+        }
+    }
+    uint bound = landmarkBound(*landmarks, coordinates_, goal_);
+    if (!anyAngle) {
+        return std::max(policy::Octagonal()(coordinates_, goal_), bound);
+    }
+    // 任意角度路径的每一段都能换成沿途cell组成的8邻域路径，其长度不超过该段的
+    // sqrt(4 - 2 * sqrt(2)) ≈ 1.0824倍，因此网格距离乘以12/13后仍是任意角度距离的下界
+    uint scaled = static_cast<uint>(static_cast<std::uint64_t>(bound) * 12 / 13);
+    return std::max(Heuristic::euclidean(coordinates_, goal_), scaled);
+}
+
+AStar::uint AStar::Generator::stepCost(Vec2i to_, uint direction_)
+{
+    // 进入to_的一步代价，前4个方向为直行；可通行的cell代价不会是BLOCKED（已被removeCollision解除）
+    GridView grid = gridView();
+    if (costLayer != nullptr) {
+        return policy::LayerCost()(grid, to_, direction_);
+    }
+    return policy::UniformCost()(grid, to_, direction_);
+}
+
+AStar::CoordinateList AStar::Generator::findPathBidirectional(Vec2i source_, Vec2i target_)
+{
+    if (source_ == target_) {
+        return{ source_ };
+    }
+    // 两侧使用平均势函数 p(v) = (h(v, 终点) - h(v, 起点)) / 2，反向取相反数：
+    // 约化后的边权在两个方向上相同且非负，相当于在同一张图上做双向Dijkstra，
+    // 两侧堆顶键值之和不小于已发现的最短相遇路径时即可停止。键值取两倍以避免小数
+    auto key = [&](uint G_, Vec2i coordinates_, int side_) {
+        uint toTarget = estimate(coordinates_, target_);
+        uint toSource = estimate(coordinates_, source_);
+        return 2 * G_ + (side_ == 0 ? toTarget - toSource : toSource - toTarget);
+    };
+
+    // 正向节点的下标存放在第一个平面，反向节点存放在第二个平面
+    SearchWorkspace& ws = activeWorkspace();
+    ws.reset(worldSize, 2);
+    NodeSet& nodes = ws.nodes;
+    std::size_t plane = static_cast<std::size_t>(worldSize.x) * worldSize.y;
+    OpenList* openLists[2] = { &ws.openList, &ws.reverseOpenList };
+    Vec2i goals[2] = { target_, source_ };
+
+    uint start = ws.addNode(source_, Node::NONE, 0, estimate(source_, target_));
+    ws.assign(cellIndex(source_), start);
+    ws.openList.push(start, key(0, source_, 0), nodes[start].H);
+    if (!detectCollision(target_)) {
+        uint goal = ws.addNode(target_, Node::NONE, 0, estimate(target_, source_));
+        ws.assign(plane + cellIndex(target_), goal);
+        ws.reverseOpenList.push(goal, key(0, target_, 1), nodes[goal].H);
     }
 
-    releaseNodes(openSet);
-    releaseNodes(closedSet);
+    // best为已发现的最短相遇路径代价，meeting为相遇的cell
+    uint best = Node::NONE;
+    Vec2i meeting = source_;
+    uint lastForward = start;
+    while (true) {
+        // 去掉两侧堆顶已关闭的旧项，使堆顶键值为该侧真实的下界
+        for (OpenList* open : openLists) {
+            while (!open->empty() && nodes[open->top()].closed) {
+                open->pop();
+            }
+        }
+        if (ws.openList.empty() || ws.reverseOpenList.empty()) {
+            break;
+        }
+        if (best != Node::NONE &&
+            ws.openList.topScore() + ws.reverseOpenList.topScore() >= 2 * best) {
+            break;
+        }
+
+        int side = ws.openList.size() <= ws.reverseOpenList.size() ? 0 : 1;
+        std::size_t ownPlane = side == 0 ? 0 : plane;
+        std::size_t otherPlane = side == 0 ? plane : 0;
+        uint current = openLists[side]->pop();
+        nodes[current].closed = true;
+        ++expandedNodes;
+        if (side == 0) {
+            lastForward = current;
+        }
+
+        Vec2i currentCoordinates = nodes[current].coordinates;
+        uint currentG = nodes[current].G;
+        for (uint i = 0; i < directions; ++i) {
+            Vec2i newCoordinates(currentCoordinates + direction[i]);
+            // 起点可以位于障碍内（与单向搜索一致），反向搜索需要能到达它
+            if (detectCollision(newCoordinates) && !(newCoordinates == source_)) {
+                continue;
+            }
+            std::size_t cell = cellIndex(newCoordinates);
+            uint successor = ws.find(ownPlane + cell);
+            if (successor != Node::NONE && nodes[successor].closed) {
+                continue;
+            }
+
+            // 反向搜索沿边的反方向前进，边的代价按正向（进入靠近终点的一端）计算
+            uint totalCost = currentG +
+                stepCost(side == 0 ? newCoordinates : currentCoordinates, i);
+            if (successor == Node::NONE) {
+                successor = ws.addNode(newCoordinates, current, totalCost,
+                                       estimate(newCoordinates, goals[side]));
+                ws.assign(ownPlane + cell, successor);
+            }
+            else if (totalCost < nodes[successor].G) {
+                nodes[successor].parent = current;
+                nodes[successor].G = totalCost;
+            }
+            else {
+                continue;
+            }
+            uint other = ws.find(otherPlane + cell);
+            if (other != Node::NONE && totalCost + nodes[other].G < best) {
+                best = totalCost + nodes[other].G;
+                meeting = newCoordinates;
+            }
+            openLists[side]->push(successor, key(totalCost, newCoordinates, side),
+                                  nodes[successor].H);
+        }
+    }
 
+    CoordinateList path;
+    if (best == Node::NONE) {
+        // 与单向搜索一致，失败时返回最后扩展的正向节点到起点的路径
+        for (uint node = lastForward; node != Node::NONE; node = nodes[node].parent) {
+            path.push_back(nodes[node].coordinates);
+        }
+        return path;
+    }
+    // 反向链从相遇点走向终点，倒序后接上从相遇点走回起点的正向链，终点在前
+    std::size_t meetingCell = cellIndex(meeting);
+    for (uint node = nodes[ws.find(plane + meetingCell)].parent; node != Node::NONE;
+         node = nodes[node].parent) {
+        path.push_back(nodes[node].coordinates);
+    }
+    std::reverse(path.begin(), path.end());
+    for (uint node = ws.find(meetingCell); node != Node::NONE; node = nodes[node].parent) {
+        path.push_back(nodes[node].coordinates);
+    }
     return path;
 }
 
-AStar::Node* AStar::Generator::findNodeOnList(NodeSet& nodes_, Vec2i coordinates_)
+AStar::CoordinateList AStar::Generator::findPathJPS(Vec2i source_, Vec2i target_)
 {
-    for (auto node : nodes_) {
-        if (node->coordinates == coordinates_) {
-            return node;
+    SearchWorkspace& ws = activeWorkspace();
+    ws.reset(worldSize);
+    NodeSet& nodes = ws.nodes;
+    OpenList& openList = ws.openList;
+    uint current = ws.addNode(source_, Node::NONE, 0, estimate(source_, target_));
+    ws.assign(cellIndex(source_), current);
+    openList.push(current, nodes[current].getScore(), nodes[current].H);
+
+    while (!openList.empty()) {
+        uint node = openList.pop();
+        if (nodes[node].closed) {
+            continue;
+        }
+        current = node;
+
+        if (nodes[current].coordinates == target_) {
+            break;
+        }
+
+        nodes[current].closed = true;
+        ++expandedNodes;
+
+        Vec2i currentCoordinates = nodes[current].coordinates;
+        uint currentG = nodes[current].G;
+        uint currentParent = nodes[current].parent;
+
+        // 起点搜索全部8个方向，其余跳点只搜索自然邻居和强制邻居方向
+        Vec2i pruned[5];
+        uint prunedCount = 0;
+        const Vec2i *candidates = direction.data();
+        uint candidateCount = directions;
+        if (currentParent != Node::NONE) {
+            Vec2i c = currentCoordinates;
+            Vec2i p = nodes[currentParent].coordinates;
+            Vec2i d = { (c.x > p.x) - (c.x < p.x), (c.y > p.y) - (c.y < p.y) };
+            if (d.x != 0 && d.y != 0) {
+                pruned[prunedCount++] = { d.x, 0 };
+                pruned[prunedCount++] = { 0, d.y };
+                pruned[prunedCount++] = d;
+                if (detectCollision({ c.x - d.x, c.y })) {
+                    pruned[prunedCount++] = { -d.x, d.y };
+                }
+                if (detectCollision({ c.x, c.y - d.y })) {
+                    pruned[prunedCount++] = { d.x, -d.y };
+                }
+            }
+            else if (d.x != 0) {
+                pruned[prunedCount++] = d;
+                if (detectCollision({ c.x, c.y + 1 })) {
+                    pruned[prunedCount++] = { d.x, 1 };
+                }
+                if (detectCollision({ c.x, c.y - 1 })) {
+                    pruned[prunedCount++] = { d.x, -1 };
+                }
+            }
+            else {
+                pruned[prunedCount++] = d;
+                if (detectCollision({ c.x + 1, c.y })) {
+                    pruned[prunedCount++] = { 1, d.y };
+                }
+                if (detectCollision({ c.x - 1, c.y })) {
+                    pruned[prunedCount++] = { -1, d.y };
+                }
+            }
+            candidates = pruned;
+            candidateCount = prunedCount;
+        }
+
+        for (uint i = 0; i < candidateCount; ++i) {
+            Vec2i jumpPoint;
+            if (!jump(currentCoordinates, candidates[i], target_, jumpPoint)) {
+                continue;
+            }
+            std::size_t cell = cellIndex(jumpPoint);
+            uint successor = ws.find(cell);
+            if (successor != Node::NONE && nodes[successor].closed) {
+                continue;
+            }
+
+            uint steps = std::max(abs(jumpPoint.x - currentCoordinates.x),
+                                  abs(jumpPoint.y - currentCoordinates.y));
+            bool diagonal = candidates[i].x != 0 && candidates[i].y != 0;
+            uint totalCost = currentG + steps * (diagonal ? 14 : 10);
+
+            if (successor == Node::NONE) {
+                successor = ws.addNode(jumpPoint, current, totalCost,
+                                       estimate(jumpPoint, target_));
+                ws.assign(cell, successor);
+                openList.push(successor, nodes[successor].getScore(), nodes[successor].H);
+            }
+            else if (totalCost < nodes[successor].G) {
+                nodes[successor].parent = current;
+                nodes[successor].G = totalCost;
+                openList.push(successor, nodes[successor].getScore(), nodes[successor].H);
+            }
         }
     }
-    return nullptr;
+
+    // 相邻跳点之间为直线或对角线，逐格展开，输出与A*相同（终点在前）
+    CoordinateList path;
+    for (uint node = current; node != Node::NONE; node = nodes[node].parent) {
+        path.push_back(nodes[node].coordinates);
+        if (nodes[node].parent != Node::NONE) {
+            Vec2i from = nodes[node].coordinates;
+            Vec2i to = nodes[nodes[node].parent].coordinates;
+            Vec2i step = { (to.x > from.x) - (to.x < from.x), (to.y > from.y) - (to.y < from.y) };
+            for (Vec2i c = from + step; !(c == to); c = c + step) {
+                path.push_back(c);
+            }
+        }
+    }
+
+    return path;
 }
 
-void AStar::Generator::releaseNodes(NodeSet& nodes_)
+bool AStar::Generator::lineOfSight(Vec2i from_, Vec2i to_, uint& extraCost_, uint& cellCount_)
 {
-    for (auto it = nodes_.begin(); it != nodes_.end();) {
-        delete *it;
-        it = nodes_.erase(it);
+    GridView grid = gridView();
+    extraCost_ = 0;
+    cellCount_ = 0;
+    return supercoverLine(
+        from_, to_, [&grid](Vec2i c) { return grid.isBlocked(c); },
+        [&](Vec2i c) {
+            if (grid.isBlocked(c)) {
+                return false;
+            }
+            if (costLayer != nullptr) {
+                extraCost_ += grid.extraCost(c);
+            }
+            ++cellCount_;
+            return true;
+        });
+}
+
+AStar::uint AStar::Generator::legCost(Vec2i from_, Vec2i to_, uint extraCost_, uint cellCount_)
+{
+    // 直线长度按沿途cell的平均附加代价放大；向上取整，保证一条直线段的代价不超过
+    // 把它拆成几段之后的代价之和，否则取整误差会让搜索偏好沿45°折线前进
+    double length = 10 * sqrt(pow(to_.x - from_.x, 2) + pow(to_.y - from_.y, 2));
+    double extra = cellCount_ > 0 ? static_cast<double>(extraCost_) / cellCount_ : 0;
+    return static_cast<uint>(ceil(length * (10 + extra) / 10));
+}
+
+bool AStar::Generator::hasForcedNeighbour(Vec2i coordinates_, Vec2i direction_)
+{
+    Vec2i c = coordinates_, d = direction_;
+    if (d.x != 0 && d.y != 0) {
+        return (detectCollision({ c.x - d.x, c.y }) &&
+                !detectCollision({ c.x - d.x, c.y + d.y })) ||
+               (detectCollision({ c.x, c.y - d.y }) &&
+                !detectCollision({ c.x + d.x, c.y - d.y }));
+    }
+    if (d.x != 0) {
+        return (detectCollision({ c.x, c.y + 1 }) && !detectCollision({ c.x + d.x, c.y + 1 })) ||
+               (detectCollision({ c.x, c.y - 1 }) && !detectCollision({ c.x + d.x, c.y - 1 }));
     }
+    return (detectCollision({ c.x + 1, c.y }) && !detectCollision({ c.x + 1, c.y + d.y })) ||
+           (detectCollision({ c.x - 1, c.y }) && !detectCollision({ c.x - 1, c.y + d.y }));
 }
 
-bool AStar::Generator::detectCollision(Vec2i coordinates_)
+bool AStar::Generator::jump(Vec2i coordinates_, Vec2i direction_, Vec2i target_, Vec2i& jumpPoint_)
 {
-    if (coordinates_.x < 0 || coordinates_.x >= worldSize.x ||
-        coordinates_.y < 0 || coordinates_.y >= worldSize.y ||
-        std::find(walls.begin(), walls.end(), coordinates_) != walls.end()) {
-        return true;
+    bool diagonal = direction_.x != 0 && direction_.y != 0;
+    Vec2i next = coordinates_;
+    while (true) {
+        next = next + direction_;
+        if (detectCollision(next)) {
+            return false;
+        }
+        if (next == target_ || hasForcedNeighbour(next, direction_)) {
+            jumpPoint_ = next;
+            return true;
+        }
+        // 对角方向上每一步都向两个分量方向做直线跳跃，找到跳点则当前位置也是跳点
+        Vec2i unused;
+        if (diagonal && (jump(next, { direction_.x, 0 }, target_, unused) ||
+                         jump(next, { 0, direction_.y }, target_, unused))) {
+            jumpPoint_ = next;
+            return true;
+        }
+    }
+}
+
+AStar::CoordinateList AStar::Generator::smoothPath(const CoordinateList& path_)
+{
+    if (path_.size() <= 2) {
+        return path_;
+    }
+    // 各段的代价，不可直线通行的段（如逐格路径中擦过棱角的对角步）按原样保留
+    std::vector<uint> legCosts(path_.size() - 1);
+    for (std::size_t k = 0; k + 1 < path_.size(); ++k) {
+        uint extra, cells;
+        lineOfSight(path_[k], path_[k + 1], extra, cells);
+        legCosts[k] = legCost(path_[k], path_[k + 1], extra, cells);
     }
-    return false;
+
+    CoordinateList result{ path_.front() };
+    std::size_t i = 0;
+    while (i + 1 < path_.size()) {
+        // 找到最远的、可直线到达且代价不高于原路径的点
+        std::size_t next = i + 1;
+        uint chainCost = legCosts[i];
+        for (std::size_t j = i + 2; j < path_.size(); ++j) {
+            chainCost += legCosts[j - 1];
+            uint extra, cells;
+            if (lineOfSight(path_[i], path_[j], extra, cells) &&
+                legCost(path_[i], path_[j], extra, cells) <= chainCost) {
+                next = j;
+            }
+        }
+        result.push_back(path_[next]);
+        i = next;
+    }
+    return result;
 }
 
-AStar::Vec2i AStar::Heuristic::getDelta(Vec2i source_, Vec2i target_)
+bool AStar::Generator::isInside(Vec2i coordinates_) const
+{
+    return coordinates_.x >= 0 && coordinates_.x < worldSize.x &&
+           coordinates_.y >= 0 && coordinates_.y < worldSize.y;
+}
+
+AStar::GridView AStar::Generator::gridView() const
+{
+    return{ worldSize, &walls, &openings, collisionLayer, costLayer };
+}
+
+bool AStar::Generator::detectCollision(Vec2i coordinates_)
 {
-    return{ abs(source_.x - target_.x),  abs(source_.y - target_.y) };
+    return gridView().isBlocked(coordinates_);
 }
 
 AStar::uint AStar::Heuristic::manhattan(Vec2i source_, Vec2i target_)
 {
-    auto delta = std::move(getDelta(source_, target_));
-    return static_cast<uint>(10 * (delta.x + delta.y));
+    return policy::Manhattan()(source_, target_);
 }
 
 AStar::uint AStar::Heuristic::euclidean(Vec2i source_, Vec2i target_)
 {
-    auto delta = std::move(getDelta(source_, target_));
-    return static_cast<uint>(10 * sqrt(pow(delta.x, 2) + pow(delta.y, 2)));
+    return policy::Euclidean()(source_, target_);
 }
 
 AStar::uint AStar::Heuristic::octagonal(Vec2i source_, Vec2i target_)
 {
-    auto delta = std::move(getDelta(source_, target_));
-    return 10 * (delta.x + delta.y) + (-6) * std::min(delta.x, delta.y);
+    return policy::Octagonal()(source_, target_);
 }
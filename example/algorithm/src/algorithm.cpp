@@ -1,9 +1,18 @@
 #include <glog/logging.h>
 #include <algorithm>    // C++ STL 算法库
+#include <atomic>
+#include <thread>
 #include "algorihtm.h"  // 选手自行设计的算法头文件
 #include "math.h"
 #include "hungarian.h"
 #include "AStar.h"
+#include "astar_3d.h"
+#include "distance_field.h"
+#include "dstar_lite.h"
+#include "hierarchical_planner.h"
+#include "path_cache.h"
+#include "reservation_table.h"
+#include "segment_collision_checker.h"
 
 void show_2dv(const std::vector<std::vector<double>>& mat) {
     for (const auto& row : mat) {
@@ -63,6 +72,9 @@ AStar::CoordinateList remove_single_step(AStar::CoordinateList& path) {
 namespace mtuav::algorithm {
 // 算法基类Algorithm函数实现
 
+// 初始化算法类静态成员变量
+int64_t Algorithm::flightplan_num = 0;
+
 void Algorithm::update_dynamic_info() {
     auto dynamic_info = DynamicGameInfo::getDynamicGameInfoPtr();
     if (dynamic_info == nullptr) {
@@ -200,6 +212,19 @@ int64_t myAlgorithm::solve() {
     for (auto d : drones_need_recharge) {
         LOG(INFO) << d.drone_id;
     }
+    // 已降落的无人机不会再悬停重规划，释放其增量规划状态
+    for (auto it = this->_replanners.begin(); it != this->_replanners.end();) {
+        bool airborne = false;
+        for (auto& drone : this->_drone_info) {
+            if (drone.drone_id == it->first &&
+                (drone.status == Status::FLYING || drone.status == Status::HOVERING)) {
+                airborne = true;
+                break;
+            }
+        }
+        it = airborne ? std::next(it) : this->_replanners.erase(it);
+    }
+
     // 获取当前毫秒时间戳
     std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds> tp =
         std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
@@ -207,6 +232,16 @@ int64_t myAlgorithm::solve() {
     int64_t current_time = current.count();
     std::vector<std::tuple<std::string, FlightPlan>> flight_plans_to_publish;
 
+    // 用已发布航线中尚未飞完的部分重建时空预约表，本轮新规划的航线在生成时依次加入
+    this->_reservations.reset(this->_map_grid);
+    for (auto& [drone_id, segs] : this->_id2segs) {
+        auto plan = this->_id2plan.find(drone_id);
+        if (plan != this->_id2plan.end()) {
+            this->_reservations.reserve(ReservationTable::owner_id(drone_id), segs,
+                                        plan->second.takeoff_timestamp, current_time);
+        }
+    }
+
     LOG(INFO) << "为没有订单的无人机生成取订单航线";
 
 
@@ -222,21 +257,46 @@ int64_t myAlgorithm::solve() {
 
 
     std::vector<std::vector<double>> cost(pickup_plan_num, std::vector<double>(pickup_plan_num, 1e10)); // 距离矩阵
-    // 计算距离矩阵
+    // 计算距离矩阵：无人机到取货点、取货点到送货点的绕障距离之和
+    // 地图无向，每个订单从取货点出发做一次单源Dijkstra，即可同时得到到各无人机和送货点的距离，
+    // 共pickup_plan_num次搜索；搜索层取巡航高度的中间层90m，不可达时退回直线距离
+    const AStar::CollisionLayer* field_layer =
+        this->_grid_pyramid.empty()
+            ? nullptr
+            : this->_grid_pyramid.collision_layer(0, this->_map_grid.world_to_cell_z(90));
+    DistanceField distance_field(this->_map_grid, field_layer);
+    auto cell_of = [this](const Vec3& p) -> AStar::Vec2i {
+        return {this->_map_grid.world_to_cell_x(p.x), this->_map_grid.world_to_cell_y(p.y)};
+    };
+    AStar::CoordinateList drone_cells;
     for (int i = 0; i < pickup_plan_num; i++) {
-        auto the_drone = drones_without_cargo.at(i); // 改进：这里仍然是随机取了几架无人机，未必最优，或可对无人机vector进行重排列
-        for (int j = 0; j < pickup_plan_num; j++) {
-            auto the_cargo = cargoes_to_delivery.at(j); // 改进：这里也是随机取了几个cargo，未必最优，或可按照剩余时间重排序
-            double distance1 = std::sqrt(
-                std::pow(the_drone.position.x - the_cargo.position.x, 2) +
-                std::pow(the_drone.position.y - the_cargo.position.y, 2)
-            );
-            double distance2 = std::sqrt(
+        drone_cells.push_back(cell_of(drones_without_cargo.at(i).position));
+    }
+    for (int j = 0; j < pickup_plan_num; j++) {
+        auto the_cargo = cargoes_to_delivery.at(j); // 改进：这里也是随机取了几个cargo，未必最优，或可按照剩余时间重排序
+        AStar::CoordinateList targets = drone_cells;
+        targets.push_back(cell_of(the_cargo.target_position));
+        distance_field.compute(cell_of(the_cargo.position), targets);
+
+        double distance2 = distance_field.distance(targets.back());
+        if (distance2 < 0) {
+            distance2 = std::sqrt(
                 std::pow(the_cargo.position.x - the_cargo.target_position.x, 2) +
                 std::pow(the_cargo.position.y - the_cargo.target_position.y, 2)
             );
+        }
+        for (int i = 0; i < pickup_plan_num; i++) {
+            auto the_drone = drones_without_cargo.at(i); // 改进：这里仍然是随机取了几架无人机，未必最优，或可对无人机vector进行重排列
+            double distance1 = distance_field.distance(drone_cells[i]);
+            if (distance1 < 0) {
+                distance1 = std::sqrt(
+                    std::pow(the_drone.position.x - the_cargo.position.x, 2) +
+                    std::pow(the_drone.position.y - the_cargo.position.y, 2)
+                );
+            }
             cost[i][j] = distance1 + distance2;
         }
+        LOG(INFO) << "订单" << the_cargo.id << "距离场确定cell数: " << distance_field.settled_cells();
     }
 
     // LOG(INFO) << "Distance calculated: ";
@@ -254,44 +314,32 @@ int64_t myAlgorithm::solve() {
     }
 
 
+    // 本轮所有取货、换电、送货航线先统一收集，再并行规划，最后按收集顺序生成飞行计划
+    std::vector<RouteRequest> route_requests;
+    std::vector<FlightPlan> route_plans;
+    auto add_route = [&](const DroneStatus& drone, const Vec3& end, const FlightPlan& plan) {
+        RouteRequest request;
+        request.drone = drone;
+        request.start = drone.position;
+        request.end = end;
+        request.takeoff_time = plan.takeoff_timestamp;
+        route_requests.push_back(request);
+        route_plans.push_back(plan);
+    };
+
     for (int i = 0; i < pickup_plan_num; i++) {
         auto the_drone = drones_without_cargo.at(i);
         auto the_cargo = cargoes_to_delivery.at(assignment[i]);
 
-        // LOG(INFO) << "go to pick cargo, id: " << the_cargo.id << ", start: " << the_cargo.position.x
-        //           << " " << the_cargo.position.y << " " << the_cargo.position.z
-        //           << ", target: " << the_cargo.target_position.x << " "
-        //           << the_cargo.target_position.y << " " << the_cargo.target_position.z;
-                
-
         FlightPlan pickup;
-        // TODO 参赛选手需要自己实现一个轨迹生成函数或中转点生成函数
-        auto [pickup_traj, pickup_flight_time] = this->trajectory_generation(
-            the_drone.position, the_cargo.position, the_drone);  //此处使用轨迹生成函数
-        // auto [pickup_waypoints, pickup_flight_time] = this->waypoints_generation(
-        //     the_drone.position, the_cargo.position);  //此处使用中转点生成函数
         pickup.target_cargo_ids.push_back(the_cargo.id);
         pickup.flight_purpose = FlightPurpose::FLIGHT_TAKE_CARGOS;  // 飞行计划目标
-        // pickup.flight_plan_type = FlightPlanType::PLAN_WAY_POINTS;  // 飞行计划类型：中转点
         pickup.flight_plan_type = FlightPlanType::PLAN_TRAJECTORIES;  // 飞行计划类型：轨迹
-        pickup.flight_id = std::to_string(++Algorithm::flightplan_num);
         pickup.takeoff_timestamp = current_time;  // 立刻起飞
-        pickup.segments = pickup_traj;
-        // 在下发飞行计划前，选手可以使用该函数自行先校验飞行计划的可行性
-        // 注意ValidateFlightPlan 只能校验起点/终点均在地面上的飞行计划
-        // auto reponse_pickup = this->_planner->ValidateFlightPlan(drone_limits, your_flight_plan)
-        flight_plans_to_publish.push_back({the_drone.drone_id, pickup});
-        LOG(INFO) << "Successfully generated flight plan, flight id: " << pickup.flight_id
-                  << ", drone id: " << the_drone.drone_id
-                  << ", flight purpose: " << int(pickup.flight_purpose)
-                  << ", flight type: " << int(pickup.flight_plan_type)
-                  << ", cargo id: " << the_cargo.id;
-
-        break;  // 每次只生成一条取货飞行计划
+        add_route(the_drone, the_cargo.position, pickup);
     }
 
     // 示例策略2：为电量小于指定数值的无人机生成换电航线
-
     for (auto the_drone : drones_need_recharge) {
         auto battery_stations = this->_task_info->battery_stations;
         // 没有换电站，无法执行换电操作
@@ -299,43 +347,24 @@ int64_t myAlgorithm::solve() {
             LOG(INFO) << "there is no battery station. ";
             break;
         }
-        // 依据距离当前无人机的具体排序
-        std::sort(battery_stations.begin(), battery_stations.end(), [the_drone](Vec3 p1, Vec3 p2) {
-            Vec3 the_drone_pos = the_drone.position;
-            double p1_to_drone = std::sqrt(std::pow(p1.x - the_drone_pos.x, 2) +
-                                           std::pow(p1.y - the_drone_pos.y, 2) +
-                                           std::pow(p1.z - the_drone_pos.z, 2));
-            double p2_to_drone = std::sqrt(std::pow(p2.x - the_drone_pos.x, 2) +
-                                           std::pow(p2.y - the_drone_pos.y, 2) +
-                                           std::pow(p2.z - the_drone_pos.z, 2));
-            return p1_to_drone < p2_to_drone;
-        });
         // 选择距离当前无人机最近的换电站
-        int the_station_idx = 0;
-        // 依次选择换电站
-        Vec3 the_selected_station;
-        if (the_station_idx < battery_stations.size()) {
-            the_selected_station = battery_stations.at(the_station_idx);
-        } else {
-            break;
-        }
+        Vec3 the_drone_pos = the_drone.position;
+        auto the_selected_station = std::min_element(
+            battery_stations.begin(), battery_stations.end(), [the_drone_pos](Vec3 p1, Vec3 p2) {
+                double p1_to_drone = std::sqrt(std::pow(p1.x - the_drone_pos.x, 2) +
+                                               std::pow(p1.y - the_drone_pos.y, 2) +
+                                               std::pow(p1.z - the_drone_pos.z, 2));
+                double p2_to_drone = std::sqrt(std::pow(p2.x - the_drone_pos.x, 2) +
+                                               std::pow(p2.y - the_drone_pos.y, 2) +
+                                               std::pow(p2.z - the_drone_pos.z, 2));
+                return p1_to_drone < p2_to_drone;
+            });
 
         FlightPlan recharge;
-        // TODO 参赛选手需要自己实现一个轨迹生成函数或中转点生成函数
-        auto [recharge_traj, recharge_flight_time] = this->trajectory_generation(
-            the_drone.position, the_selected_station, the_drone);  //此处使用轨迹生成函数
         recharge.flight_purpose = FlightPurpose::FLIGHT_EXCHANGE_BATTERY;
         recharge.flight_plan_type = FlightPlanType::PLAN_TRAJECTORIES;
-        recharge.flight_id = std::to_string(++Algorithm::flightplan_num);
         recharge.takeoff_timestamp = current_time;  // 立刻起飞
-        recharge.segments = recharge_traj;
-        flight_plans_to_publish.push_back({the_drone.drone_id, recharge});
-        LOG(INFO) << "first point z: " << recharge_traj.front().position.z;
-        LOG(INFO) << "Successfully generated flight plan, flight id: " << recharge.flight_id
-                  << ", drone id: " << the_drone.drone_id
-                  << ", flight purpose: " << int(recharge.flight_purpose)
-                  << ", flight type: " << int(recharge.flight_plan_type) << ", cargo id: none";
-        break;  // 每次只生成一条换电飞行计划
+        add_route(the_drone, *the_selected_station, recharge);
     }
 
     // 示例策略3：为已经取货的飞机生成送货飞行计划
@@ -351,33 +380,41 @@ int64_t myAlgorithm::solve() {
         if (this->_cargo_info.find(the_cargo_id) != this->_cargo_info.end()) {
             auto the_cargo = this->_cargo_info.at(the_cargo_id);
             FlightPlan delivery;
-            auto [delivery_traj, delivery_flight_time] = this->trajectory_generation(
-                the_drone.position, the_cargo.target_position, the_drone);
-            if (delivery_flight_time == -1) {
-                // 轨迹生成失败
-                LOG(INFO) << "trajectory generation failed. ";
-                break;
-            }
             delivery.flight_purpose = FlightPurpose::FLIGHT_DELIVER_CARGOS;
             delivery.flight_plan_type = FlightPlanType::PLAN_TRAJECTORIES;
-            delivery.flight_id = std::to_string(++Algorithm::flightplan_num);
             delivery.takeoff_timestamp = current_time;
-            delivery.segments = delivery_traj;
             delivery.target_cargo_ids.push_back(the_cargo.id);
-            flight_plans_to_publish.push_back({the_drone.drone_id, delivery});
-            LOG(INFO) << "Successfully generated flight plan, flight id: " << delivery.flight_id
-                      << ", drone id: " << the_drone.drone_id
-                      << ", flight purpose: " << int(delivery.flight_purpose)
-                      << ", flight type: " << int(delivery.flight_plan_type)
-                      << ", cargo id: " << the_cargo.id;
-            break;  // 每次只生成一条送货飞行计划
+            add_route(the_drone, the_cargo.target_position, delivery);
         }
     }
 
+    this->plan_routes(route_requests);
+    for (size_t i = 0; i < route_requests.size(); i++) {
+        const std::string& drone_id = route_requests[i].drone.drone_id;
+        FlightPlan& plan = route_plans[i];
+        if (!route_requests[i].success) {
+            // 轨迹生成失败
+            LOG(INFO) << "trajectory generation failed, drone id: " << drone_id;
+            continue;
+        }
+        plan.flight_id = std::to_string(++Algorithm::flightplan_num);
+        plan.segments = route_requests[i].traj_segs;
+        // 在下发飞行计划前，选手可以使用该函数自行先校验飞行计划的可行性
+        // 注意ValidateFlightPlan 只能校验起点/终点均在地面上的飞行计划
+        // auto reponse_pickup = this->_planner->ValidateFlightPlan(drone_limits, your_flight_plan)
+        flight_plans_to_publish.push_back({drone_id, plan});
+        LOG(INFO) << "Successfully generated flight plan, flight id: " << plan.flight_id
+                  << ", drone id: " << drone_id
+                  << ", flight purpose: " << int(plan.flight_purpose)
+                  << ", flight type: " << int(plan.flight_plan_type) << ", cargo id: "
+                  << (plan.target_cargo_ids.empty() ? std::string("none")
+                                                    : std::to_string(plan.target_cargo_ids[0]));
+    }
+
     // 重现规划悬停中的无人机
     for (auto& this_drone : drones_hovering) {
         FlightPlan replan;
-        auto [replan_traj, replan_flight_time] = this->trajectory_replan(this_drone.position, this->_id2segs[this_drone.drone_id].back().position, this_drone);
+        auto [replan_traj, replan_flight_time] = this->trajectory_replan(this_drone.position, this->_id2segs[this_drone.drone_id].back().position, this_drone, current_time);
         replan.flight_purpose = this->_id2plan[this_drone.drone_id].flight_purpose;
         replan.flight_plan_type = FlightPlanType::PLAN_TRAJECTORIES;
         replan.flight_id = std::to_string(++Algorithm::flightplan_num);
@@ -391,7 +428,7 @@ int64_t myAlgorithm::solve() {
     for (auto& [drone_id, flightplan] : flight_plans_to_publish) {
         auto publish_result = this->_planner->DronePlanFlight(drone_id, flightplan);
 
-        this->_id2plan.insert(std::make_pair(drone_id, flightplan));
+        this->_id2plan[drone_id] = flightplan;
 
         LOG(INFO) << "Published flight plan, flight id: " << flightplan.flight_id
                   << ", successfully?: " << std::boolalpha << publish_result.success
@@ -452,29 +489,24 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::waypoints_generation(Vec3
     int altitude_bias = (min_index - 2) * 10;
     int altitude = 90 + altitude_bias;
 
-    int grid_n_x = this->_map_grid.size();
-    int grid_n_y = this->_map_grid[0].size();
-    int grid_n_z = this->_map_grid[0][0].size();
-
-    AStar::Generator generator;
-    generator.setWorldSize({grid_n_x, grid_n_y}); // 跟map_grid的大小一样
-    generator.setHeuristic(AStar::Heuristic::euclidean);
-    generator.setDiagonalMovement(true);
+    int grid_layer = this->_map_grid.world_to_cell_z(altitude);
 
-    for (int x = 0; x < grid_n_x; x++) {
-        for (int y = 0; y < grid_n_y; y++) {
-            if (this->_map_grid[x][y][(int)(altitude / this->_cell_size_z)] == 1) {
-                generator.addCollision({x, y});
-            }
-        }
+    // 分层A*：先在粗网格上找走廊，再在走廊内细化
+    HierarchicalPlanner hierarchical_planner(this->_grid_pyramid);
+    if (!this->_semantic_costs.empty()) {
+        hierarchical_planner.set_cost_layer(&this->_semantic_costs.layer());
     }
+    // 任意角度路径：航点更少，每个航点处的加减速也更少
+    hierarchical_planner.set_any_angle(true);
+    hierarchical_planner.set_workspace(&this->_search_workspace);
+    hierarchical_planner.set_landmarks(&this->_landmarks);
 
     LOG(INFO) << "开始计算路径点...";
-    int start_grid_x = (int)(start.x / this->_cell_size_x);
-    int start_grid_y = (int)(start.y / this->_cell_size_y);
-    int end_grid_x = (int)(end.x / this->_cell_size_x);
-    int end_grid_y = (int)(end.y / this->_cell_size_y); 
-    auto path = generator.findPath({start_grid_x, start_grid_y}, {end_grid_x, end_grid_y});
+    int start_grid_x = this->_map_grid.world_to_cell_x(start.x);
+    int start_grid_y = this->_map_grid.world_to_cell_y(start.y);
+    int end_grid_x = this->_map_grid.world_to_cell_x(end.x);
+    int end_grid_y = this->_map_grid.world_to_cell_y(end.y);
+    auto path = hierarchical_planner.find_path({start_grid_x, start_grid_y}, {end_grid_x, end_grid_y}, grid_layer);
     std::reverse(path.begin(), path.end());
     // 移除n点连线中间的n-2个点
     auto path_remove_middle = remove_middle_points(path);
@@ -507,8 +539,8 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::waypoints_generation(Vec3
     for (int i = 1; i < path_remove_middle.size() - 1; i++) {
         Segment p_air;
         AStar::Vec2i coordinate = path_remove_middle[i];
-        p_air.position.x = coordinate.x * this->_cell_size_x + 0.5 * this->_cell_size_x;
-        p_air.position.y = coordinate.y * this->_cell_size_y + 0.5 * this->_cell_size_y;
+        p_air.position.x = this->_map_grid.cell_center_x(coordinate.x);
+        p_air.position.y = this->_map_grid.cell_center_y(coordinate.y);
         p_air.position.z = altitude;
         // TODO 计算时间
         p_air.time_ms = 10000;
@@ -537,32 +569,24 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::waypoints_generation(Vec3
 }
 
 // 在飞行过程重新规划，不包含在起飞和降落中
-std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_replan(Vec3 start, Vec3 end, DroneStatus this_drone) {
+std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_replan(Vec3 start, Vec3 end, DroneStatus this_drone,
+                                                                          int64_t takeoff_time) {
     float altitude = this_drone.position.z;
 
-    int grid_n_x = this->_map_grid.size();
-    int grid_n_y = this->_map_grid[0].size();
-    int grid_n_z = this->_map_grid[0][0].size();
+    int grid_layer = this->_map_grid.world_to_cell_z(altitude);
 
     // A*算法
-    AStar::Generator generator;
-    generator.setWorldSize({grid_n_x, grid_n_y}); // 跟map_grid的大小一样
-    generator.setHeuristic(AStar::Heuristic::euclidean);
-    generator.setDiagonalMovement(true);
-
-    for (int x = 0; x < grid_n_x; x++) {
-        for (int y = 0; y < grid_n_y; y++) {
-            if (this->_map_grid[x][y][(int)(altitude / this->_cell_size_z)] == 1) {
-                generator.addCollision({x, y});
-            }
-        }
+    // 分层A*：先在粗网格上找走廊，再在走廊内细化
+    HierarchicalPlanner hierarchical_planner(this->_grid_pyramid);
+    if (!this->_semantic_costs.empty()) {
+        hierarchical_planner.set_cost_layer(&this->_semantic_costs.layer());
     }
+    // 任意角度路径：航点更少，每个航点处的加减速也更少
+    hierarchical_planner.set_any_angle(true);
+    hierarchical_planner.set_workspace(&this->_search_workspace);
+    hierarchical_planner.set_landmarks(&this->_landmarks);
 
-    std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds> tp =
-        std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
-    auto current = std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch());
-    int64_t current_time = current.count();
-
+    AStar::CoordinateList drone_collisions;
     for (auto& drone : this->_drone_info) {
         if (drone.drone_id != this_drone.drone_id) {
             // 计算其他无人机的位置作为障碍
@@ -571,17 +595,16 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_replan(Vec3 st
                 // 计算每个seg的绝对时间
                 int64_t seg_time = this->_id2plan[drone.drone_id].takeoff_timestamp + segment.time_ms;
                 // 将其他无人机未来一段时间的轨迹视为障碍，暂定为未来10s
-                if (seg_time >= current_time && seg_time <= current_time + 10000) {
-                    int grid_x = (int)(segment.position.x / this->_cell_size_x);
-                    int grid_y = (int)(segment.position.y / this->_cell_size_y);
-                    generator.addCollision({grid_x, grid_y});
+                if (seg_time >= takeoff_time && seg_time <= takeoff_time + 10000) {
+                    int grid_x = this->_map_grid.world_to_cell_x(segment.position.x);
+                    int grid_y = this->_map_grid.world_to_cell_y(segment.position.y);
+                    drone_collisions.push_back({grid_x, grid_y});
                 }
             }
         }
     }
 
-    generator.removeCollision({(int)(start.x / this->_cell_size_x), (int)(start.y / this->_cell_size_y)});
-    generator.removeCollision({(int)(end.x / this->_cell_size_y), (int)(end.y / this->_cell_size_y)});
+    // 其他无人机的航线作为临时障碍，分层规划器会保证起点和终点不被堵住
 
     // TODOs：
     // 如果障碍物把目的地（地面）堵住了，怎么办
@@ -589,11 +612,44 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_replan(Vec3 st
 
     // 以下是假设在平飞过程中的状态，即不考虑起飞航线
     LOG(INFO) << "开始计算路径点...";
-    int start_grid_x = (int)(start.x / this->_cell_size_x);
-    int start_grid_y = (int)(start.y / this->_cell_size_y);
-    int end_grid_x = (int)(end.x / this->_cell_size_x);
-    int end_grid_y = (int)(end.y / this->_cell_size_y); 
-    auto path = generator.findPath({start_grid_x, start_grid_y}, {end_grid_x, end_grid_y});
+    int start_grid_x = this->_map_grid.world_to_cell_x(start.x);
+    int start_grid_y = this->_map_grid.world_to_cell_y(start.y);
+    int end_grid_x = this->_map_grid.world_to_cell_x(end.x);
+    int end_grid_y = this->_map_grid.world_to_cell_y(end.y);
+    AStar::Vec2i start_cell = {start_grid_x, start_grid_y};
+    AStar::Vec2i end_cell = {end_grid_x, end_grid_y};
+
+    // 同一架无人机反复悬停时终点与高度层不变，只有起点和其他无人机的位置在变，
+    // 用D* Lite保留上一次的搜索结果，只更新变化的部分
+    const AStar::CollisionLayer* collision_layer =
+        this->_grid_pyramid.empty() ? nullptr
+                                    : this->_grid_pyramid.collision_layer(0, grid_layer);
+    const AStar::CostLayer* cost_layer =
+        this->_semantic_costs.empty() ? nullptr : &this->_semantic_costs.layer();
+    // ALT距离表在后台计算完成后才可用，届时重建一次搜索状态
+    const AStar::LandmarkTable* landmarks = this->_landmarks.table(grid_layer);
+    DStarLite& replanner = this->_replanners[this_drone.drone_id];
+    if (!replanner.matches(collision_layer, cost_layer, end_cell, landmarks)) {
+        replanner.reset(collision_layer, cost_layer, end_cell, landmarks);
+    }
+    auto path = replanner.find_path(start_cell, drone_collisions);
+    if (HierarchicalPlanner::reached(path, end_cell)) {
+        LOG(INFO) << "D* Lite增量重规划, 扩展节点数: " << replanner.expanded_nodes()
+                  << ", 障碍变化cell数: " << replanner.changed_cells();
+        // 与分层规划的任意角度结果一致，合并为直线可通行的拐点
+        AStar::Generator generator;
+        generator.setWorldSize({this->_map_grid.size_x(), this->_map_grid.size_y()});
+        generator.setCollisionLayer(collision_layer);
+        generator.setCostLayer(cost_layer);
+        for (auto& coordinate : drone_collisions) {
+            generator.addCollision(coordinate);
+        }
+        generator.removeCollision(start_cell);
+        generator.removeCollision(end_cell);
+        path = generator.smoothPath(path);
+    } else {
+        path = hierarchical_planner.find_path(start_cell, end_cell, grid_layer, drone_collisions);
+    }
     std::reverse(path.begin(), path.end());
     // 移除n点连线中间的n-2个点
     auto path_remove_middle = remove_middle_points(path);
@@ -624,12 +680,13 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_replan(Vec3 st
     for (int i = 1; i < path_remove_middle.size() - 1; i++) {
         Vec3 point;
         AStar::Vec2i coordinate = path_remove_middle[i];
-        point.x = coordinate.x * this->_cell_size_x + 0.5 * this->_cell_size_x;
-        point.y = coordinate.y * this->_cell_size_y + 0.5 * this->_cell_size_y;
+        point.x = this->_map_grid.cell_center_x(coordinate.x);
+        point.y = this->_map_grid.cell_center_y(coordinate.y);
         point.z = altitude;
         flying_points.push_back(point);
     }
     flying_points.push_back(p_end_air.position);
+    this->log_blocked_legs(flying_points);
     std::vector<Segment> flying_segs;
     bool success_flying = tg.generate_traj_from_waypoints(flying_points, dl, 1, flying_segs);
     if (success_flying == false) {
@@ -659,60 +716,211 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_replan(Vec3 st
     traj_segs.insert(traj_segs.end(), landing_segs.begin(), landing_segs.end());
 
     flight_time = flying_flight_time + landing_flight_time;
+    log_clearance(traj_segs);
 
-    this->_id2segs.insert(std::make_pair(this_drone.drone_id, traj_segs));
+    this->_id2segs[this_drone.drone_id] = traj_segs;
+    this->_reservations.reserve(ReservationTable::owner_id(this_drone.drone_id), traj_segs,
+                                takeoff_time);
     return {traj_segs, flight_time};    
 }
 
 std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_generation(Vec3 start, Vec3 end,
-                                                                                DroneStatus drone) {
-    // 计算待规划航线的高度
-    auto min_element = std::min_element(this->_altitude_drone_count.begin(), this->_altitude_drone_count.end());
-    int min_index = std::distance(this->_altitude_drone_count.begin(), min_element);
-    int altitude_bias = (min_index - 2) * 10;
-    int altitude = 90 + altitude_bias;
-    // int altitude = 90;
+                                                                                DroneStatus drone,
+                                                                                int64_t takeoff_time) {
+    std::vector<RouteRequest> requests(1);
+    requests[0].drone = drone;
+    requests[0].start = start;
+    requests[0].end = end;
+    requests[0].takeoff_time = takeoff_time;
+    this->plan_routes(requests);
+    if (!requests[0].success) {
+        return {std::vector<mtuav::Segment>{}, -1};
+    }
+    return {requests[0].traj_segs, requests[0].traj_segs.back().time_ms};
+}
+
+void myAlgorithm::plan_routes(std::vector<RouteRequest>& requests) {
+    if (requests.empty()) {
+        return;
+    }
+    auto start_time = std::chrono::steady_clock::now();
+    // 巡航高度与缓存查询按请求顺序依次处理，使规划结果只取决于请求顺序而与线程调度无关
+    int cached_num = 0;
+    for (auto& request : requests) {
+        auto min_element = std::min_element(this->_altitude_drone_count.begin(),
+                                            this->_altitude_drone_count.end());
+        request.altitude_index = std::distance(this->_altitude_drone_count.begin(), min_element);
+        request.altitude = 90 + (request.altitude_index - 2) * 10;
+        this->_altitude_drone_count[request.altitude_index] += 1;
+        request.grid_layer = this->_map_grid.world_to_cell_z(request.altitude);
+        request.start_cell = {this->_map_grid.world_to_cell_x(request.start.x),
+                              this->_map_grid.world_to_cell_y(request.start.y), request.grid_layer};
+        request.end_cell = {this->_map_grid.world_to_cell_x(request.end.x),
+                            this->_map_grid.world_to_cell_y(request.end.y), request.grid_layer};
+        // 相同起终点与高度的路线直接取缓存的拐点
+        request.cached =
+            this->_path_cache.lookup(request.start_cell, request.end_cell, request.corners);
+        cached_num += request.cached ? 1 : 0;
+    }
+    LOG(INFO) << "路径缓存命中: " << cached_num << "/" << requests.size()
+              << ", 累计命中率: " << this->_path_cache.hit_rate();
+
+    // 搜索与轨迹生成互不依赖，由各线程从队列中领取，每个线程使用自己的搜索状态
+    int request_num = requests.size();
+    int thread_num = this->_planning_threads;
+    if (thread_num <= 0) {
+        thread_num = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_num = std::max(1, std::min(thread_num, request_num));
+    while ((int)this->_planning_workspaces.size() < thread_num) {
+        this->_planning_workspaces.emplace_back(new PlanningWorkspace());
+    }
+    std::atomic<int> next_request{0};
+    auto worker = [this, &requests, &next_request, request_num](PlanningWorkspace* workspace) {
+        while (true) {
+            int idx = next_request.fetch_add(1);
+            if (idx >= request_num) {
+                break;
+            }
+            this->search_route(requests[idx], *workspace);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < thread_num; i++) {
+        workers.emplace_back(worker, this->_planning_workspaces[i].get());
+    }
+    worker(this->_planning_workspaces[0].get());  // 主线程也参与计算
+    for (auto& t : workers) {
+        t.join();
+    }
 
-    int grid_n_x = this->_map_grid.size();
-    int grid_n_y = this->_map_grid[0].size();
-    int grid_n_z = this->_map_grid[0][0].size();
+    // 按请求顺序合并：写入缓存、与已发布及本批靠前的航线做冲突检查并预约
+    int success_num = 0;
+    for (auto& request : requests) {
+        this->commit_route(request);
+        success_num += request.success ? 1 : 0;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time);
+    LOG(INFO) << "批量规划航线数: " << request_num << ", 成功: " << success_num
+              << ", 线程数: " << thread_num << ", 耗时: " << elapsed.count() << " ms";
+}
 
-    // A*算法
-    AStar::Generator generator;
-    generator.setWorldSize({grid_n_x, grid_n_y}); // 跟map_grid的大小一样
-    generator.setHeuristic(AStar::Heuristic::euclidean);
-    generator.setDiagonalMovement(true);
-
-    for (int x = 0; x < grid_n_x; x++) {
-        for (int y = 0; y < grid_n_y; y++) {
-            if (this->_map_grid[x][y][(int)(altitude / this->_cell_size_z)] == 1) {
-                generator.addCollision({x, y});
+void myAlgorithm::search_route(RouteRequest& request, PlanningWorkspace& workspace) {
+    DroneLimits dl = this->_task_info->drones.front().drone_limits;
+    if (!request.cached) {
+        // 三维A*：起终点在分配的巡航高度上，途中可在70~110m之间升降，以飞行时间为代价
+        AStar3D planner_3d(this->_map_grid, dl);
+        planner_3d.set_altitude_range(70, 110);
+        planner_3d.set_workspace(&workspace.search_3d);
+        // 每次升降会在航点处多一次减速、加速，按一次加减速损失的时间计入代价
+        if (dl.max_fly_acc_h > 0) {
+            planner_3d.set_climb_penalty(dl.max_fly_speed_h / dl.max_fly_acc_h);
+        }
+        if (!this->_semantic_costs.empty()) {
+            planner_3d.set_cost_layer(&this->_semantic_costs.layer());
+        }
+        auto path_3d = planner_3d.find_path(request.start_cell, request.end_cell);
+        if (!path_3d.empty()) {
+            // 逐格路径只有45°/90°的折线，在同一层上按直线可通行性合并拐点，减少航点处的加减速
+            SegmentCollisionChecker checker(this->_map_grid);
+            if (!this->_semantic_costs.empty()) {
+                checker.set_cost_layer(&this->_semantic_costs.layer());
+            }
+            request.corners = planner_3d.merge_corners(path_3d, checker);
+            LOG(INFO) << "无人机" << request.drone.drone_id
+                      << " 三维A*扩展节点数: " << planner_3d.expanded_nodes()
+                      << ", 预计巡航时间: " << planner_3d.path_time() << "s";
+        } else {
+            // 三维搜索失败时退回单一高度的分层A*：先在粗网格上找走廊，再在走廊内细化
+            HierarchicalPlanner hierarchical_planner(this->_grid_pyramid);
+            if (!this->_semantic_costs.empty()) {
+                hierarchical_planner.set_cost_layer(&this->_semantic_costs.layer());
+            }
+            hierarchical_planner.set_any_angle(true);
+            hierarchical_planner.set_workspace(&workspace.search);
+            hierarchical_planner.set_landmarks(&this->_landmarks);
+            auto path = hierarchical_planner.find_path(
+                {request.start_cell.x, request.start_cell.y},
+                {request.end_cell.x, request.end_cell.y}, request.grid_layer);
+            std::reverse(path.begin(), path.end());
+            // 移除n点连线中间的n-2个点
+            for (auto& coordinate : remove_middle_points(path)) {
+                request.corners.push_back({coordinate.x, coordinate.y, request.grid_layer});
             }
         }
     }
+    request.success = this->build_trajectory(request.start, request.end, request.altitude,
+                                             request.grid_layer, request.corners,
+                                             request.traj_segs);
+}
 
-    LOG(INFO) << "开始计算路径点...";
-    int start_grid_x = (int)(start.x / this->_cell_size_x);
-    int start_grid_y = (int)(start.y / this->_cell_size_y);
-    int end_grid_x = (int)(end.x / this->_cell_size_x);
-    int end_grid_y = (int)(end.y / this->_cell_size_y); 
-    auto path = generator.findPath({start_grid_x, start_grid_y}, {end_grid_x, end_grid_y});
-    std::reverse(path.begin(), path.end());
-    // 移除n点连线中间的n-2个点
-    auto path_remove_middle = remove_middle_points(path);
-    auto path_remove_single_step = remove_single_step(path_remove_middle);
-    LOG(INFO) << "轨迹点1：";
-    for (auto& coordinate : path_remove_middle) {
-        LOG(INFO) << coordinate.x << " " << coordinate.y;
+void myAlgorithm::commit_route(RouteRequest& request) {
+    if (!request.success) {
+        LOG(INFO) << "无人机" << request.drone.drone_id << " 轨迹生成失败";
+        this->_altitude_drone_count[request.altitude_index] -= 1;
+        return;
     }
-    LOG(INFO) << "轨迹点2：";
-    for (auto& coordinate : path_remove_single_step) {
-        LOG(INFO) << coordinate.x << " " << coordinate.y;
+    // 只缓存到达终点的路径
+    if (!request.cached && request.corners.size() >= 2 &&
+        request.corners.back().x == request.end_cell.x &&
+        request.corners.back().y == request.end_cell.y) {
+        this->_path_cache.insert(request.start_cell, request.end_cell, request.corners);
     }
-    LOG(INFO) << "路径点计算完毕...";
+    LOG(INFO) << "无人机" << request.drone.drone_id << " 拐点数: " << request.corners.size();
 
-    std::vector<Segment> traj_segs;
-    int64_t flight_time;
+    // 与其他无人机已发布的轨迹做时空冲突检查，有冲突时按预约表做一次时空A*重新规划
+    DroneLimits dl = this->_task_info->drones.front().drone_limits;
+    uint32_t owner = ReservationTable::owner_id(request.drone.drone_id);
+    std::vector<Segment>& traj_segs = request.traj_segs;
+    int64_t takeoff_time = request.takeoff_time;
+    int conflict_num = this->_reservations.count_conflicts(traj_segs, takeoff_time, owner);
+    if (conflict_num > 0) {
+        // 巡航段从起飞段结束时开始
+        int64_t cruise_start_ms = 0;
+        for (auto& seg : traj_segs) {
+            if (seg.seg_type == 0) {
+                cruise_start_ms = seg.time_ms;
+            }
+        }
+        AStar3D space_time_planner(this->_map_grid, dl);
+        space_time_planner.set_altitude_range(70, 110);
+        space_time_planner.set_workspace(&this->_search_workspace_3d);
+        if (dl.max_fly_acc_h > 0) {
+            space_time_planner.set_climb_penalty(dl.max_fly_speed_h / dl.max_fly_acc_h);
+        }
+        if (!this->_semantic_costs.empty()) {
+            space_time_planner.set_cost_layer(&this->_semantic_costs.layer());
+        }
+        space_time_planner.set_reservations(&this->_reservations, owner,
+                                            takeoff_time + cruise_start_ms);
+        auto path_3d = space_time_planner.find_path(request.start_cell, request.end_cell);
+        // 时空路径不合并拐点：合并会改变经过各cell的时间，使避让预约的结果失效
+        std::vector<Segment> deconflicted_segs;
+        if (!path_3d.empty() &&
+            this->build_trajectory(request.start, request.end, request.altitude,
+                                   request.grid_layer, AStar3D::corner_points(path_3d),
+                                   deconflicted_segs)) {
+            int deconflicted_num =
+                this->_reservations.count_conflicts(deconflicted_segs, takeoff_time, owner);
+            LOG(INFO) << "时空冲突采样点数: " << conflict_num << " -> " << deconflicted_num
+                      << ", 时空A*扩展节点数: " << space_time_planner.expanded_nodes();
+            if (deconflicted_num < conflict_num) {
+                traj_segs = std::move(deconflicted_segs);
+            }
+        } else {
+            LOG(INFO) << "时空A*未找到无冲突路径, 冲突采样点数: " << conflict_num;
+        }
+    }
+
+    log_clearance(traj_segs);
+    this->_id2segs[request.drone.drone_id] = traj_segs;
+    this->_reservations.reserve(owner, traj_segs, takeoff_time);
+}
+
+bool myAlgorithm::build_trajectory(Vec3 start, Vec3 end, int altitude, int grid_layer,
+                                   const std::vector<Grid3>& corners,
+                                   std::vector<Segment>& traj_segs) {
     TrajectoryGeneration tg;
     DroneLimits dl = this->_task_info->drones.front().drone_limits;
 
@@ -737,42 +945,37 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_generation(Vec
     bool success_takeoff = tg.generate_traj_from_waypoints({p_start_land.position, p_start_air.position}, dl, 0, takeoff_segs);
     if (success_takeoff == false) {
         LOG(INFO) << "生成起飞轨迹失败！";
-        return {std::vector<mtuav::Segment>{}, -1};
+        return false;
     }
-    int64_t takeoff_flight_time = takeoff_segs.back().time_ms;
 
     // 生成飞行轨迹
     std::vector<Vec3> flying_points;
     flying_points.push_back(p_start_air.position);
-    for (int i = 1; i < path_remove_middle.size() - 1; i++) {
-    // for (int i = 1; i < path_remove_single_step.size() - 1; i++) {
+    for (int i = 1; i < (int)corners.size() - 1; i++) {
         Vec3 point;
-        AStar::Vec2i coordinate = path_remove_middle[i];
-        // AStar::Vec2i coordinate = path_remove_single_step[i];
-        point.x = coordinate.x * this->_cell_size_x + 0.5 * this->_cell_size_x;
-        point.y = coordinate.y * this->_cell_size_y + 0.5 * this->_cell_size_y;
-        point.z = altitude;
+        Grid3 cell = corners[i];
+        point.x = this->_map_grid.cell_center_x(cell.x);
+        point.y = this->_map_grid.cell_center_y(cell.y);
+        // 以分配的巡航高度为基准按层升降
+        point.z = altitude + (cell.z - grid_layer) * this->_map_grid.cell_size_z();
         flying_points.push_back(point);
     }
     flying_points.push_back(p_end_air.position);
+    this->log_blocked_legs(flying_points);
     std::vector<Segment> flying_segs;
     bool success_flying = tg.generate_traj_from_waypoints(flying_points, dl, 1, flying_segs);
     if (success_flying == false) {
         LOG(INFO) << "生成飞行轨迹失败！";
-        return {std::vector<mtuav::Segment>{}, -1};
+        return false;
     }    
-    int64_t flying_flight_time = flying_segs.back().time_ms;
 
     // 生成降落轨迹
     std::vector<Segment> landing_segs;
     bool success_landing = tg.generate_traj_from_waypoints({p_end_air.position, p_end_land.position}, dl, 2, landing_segs);
     if (success_landing == false) {
         LOG(INFO) << "生成降落轨迹失败！";
-        return {std::vector<mtuav::Segment>{}, -1};
+        return false;
     }
-    int64_t landing_flight_time = landing_segs.back().time_ms;
-
-    this->_altitude_drone_count[min_index] += 1;
 
     // 合并
 
@@ -793,10 +996,7 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_generation(Vec
     traj_segs.insert(traj_segs.end(), takeoff_segs.begin(), takeoff_segs.end());
     traj_segs.insert(traj_segs.end(), flying_segs.begin(), flying_segs.end());
     traj_segs.insert(traj_segs.end(), landing_segs.begin(), landing_segs.end());
-
-    flight_time = takeoff_flight_time + flying_flight_time + landing_flight_time;
-    this->_id2segs.insert(std::make_pair(drone.drone_id, traj_segs));
-    return {traj_segs, flight_time};
+    return true;
 }
 
 
@@ -920,6 +1120,36 @@ std::tuple<std::vector<Segment>, int64_t> myAlgorithm::trajectory_generation(Vec
 //     return {p1top4_segs, p1top4_flight_time};
 // }
 
+void myAlgorithm::log_blocked_legs(const std::vector<Vec3>& points) {
+    SegmentCollisionChecker checker(this->_map_grid);
+    // 巡航高度上的水平航段用距离层球追踪，安全距离与构建网格时判定占据的半个cell一致
+    checker.set_esdf_layers(&this->_esdf_layers, 0.5 * this->_map_grid.cell_size_x());
+    std::vector<LineSegment> legs;
+    for (size_t i = 1; i < points.size(); i++) {
+        legs.push_back({points[i - 1], points[i]});
+    }
+    std::vector<SegmentHit> hits;
+    checker.check(legs, hits);
+    for (size_t i = 0; i < hits.size(); i++) {
+        if (hits[i].blocked) {
+            LOG(INFO) << "警告：第" << i << "段航线穿过障碍物，碰撞点: " << hits[i].hit_point.x
+                      << " " << hits[i].hit_point.y << " " << hits[i].hit_point.z;
+        }
+    }
+}
+
+void myAlgorithm::log_clearance(const std::vector<Segment>& segs) {
+    float clearance;
+    if (!this->_esdf_layers.min_clearance(segs, &clearance)) {
+        return;
+    }
+    if (clearance <= 0) {
+        LOG(INFO) << "警告：轨迹穿过障碍物，最小离障距离: " << clearance;
+    } else {
+        LOG(INFO) << "轨迹最小离障距离: " << clearance;
+    }
+}
+
 std::string myAlgorithm::segments_to_string(std::vector<Segment> segs) {
     std::string str = "";
     for (auto s : segs) {
@@ -0,0 +1,374 @@
+#include "astar_3d.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace mtuav::algorithm {
+
+namespace {
+const uint8_t kClosed = 1;
+const uint8_t kBlocked = 2;
+
+// 10邻域：同层8个方向（顺序与AStar::Generator一致）加上升、下降
+const Grid3 kMoves[10] = {
+    {0, 1, 0},  {1, 0, 0}, {0, -1, 0}, {-1, 0, 0}, {-1, -1, 0},
+    {1, 1, 0}, {-1, 1, 0}, {1, -1, 0}, {0, 0, 1},  {0, 0, -1},
+};
+
+int sign(int v) { return (v > 0) - (v < 0); }
+
+// TrajectoryGeneration的航段速度曲线：从静止以加速度a加速到v、匀速、再减速到静止
+// 长度为s的航段的总时间
+double leg_time(double s, double v, double a) {
+    if (a <= 0) {
+        return s / v;
+    }
+    return s > v * v / a ? s / v + v / a : 2 * std::sqrt(s / a);
+}
+// 航段开始后飞过s米的时间，按尚未开始减速估计
+double leg_progress_time(double s, double v, double a) {
+    if (a <= 0) {
+        return s / v;
+    }
+    return s > v * v / (2 * a) ? s / v + v / (2 * a) : std::sqrt(2 * s / a);
+}
+}  // namespace
+
+AStar3D::AStar3D(const OccupancyGrid& grid, const DroneLimits& limits)
+    : _grid(grid),
+      _speed_h(std::max(limits.max_fly_speed_h, 1e-3)),
+      _speed_v(std::max(limits.max_fly_speed_v, 1e-3)),
+      _acc_h(limits.max_fly_acc_h),
+      _acc_v(limits.max_fly_acc_v),
+      _z_min(0),
+      _z_max(grid.size_z() - 1) {
+    if (limits.max_fly_height > limits.min_fly_height) {
+        this->set_altitude_range(limits.min_fly_height, limits.max_fly_height);
+    }
+}
+
+void AStar3D::set_altitude_range(double min_z, double max_z) {
+    this->_z_min = std::max(this->_z_min, this->_grid.world_to_cell_z(min_z));
+    this->_z_max = std::min(this->_z_max, this->_grid.world_to_cell_z(max_z));
+}
+
+void AStar3D::set_climb_penalty(double seconds) {
+    this->_climb_penalty = std::max(0.0, seconds);
+}
+
+void AStar3D::set_cost_layer(const AStar::CostLayer* cost_layer) {
+    this->_cost_layer = cost_layer;
+}
+
+void AStar3D::set_workspace(Workspace* workspace) {
+    this->_workspace = workspace;
+}
+
+void AStar3D::set_reservations(const ReservationTable* reservations, uint32_t owner,
+                               int64_t departure_ms) {
+    this->_reservations = reservations;
+    this->_owner = owner;
+    this->_departure_ms = departure_ms;
+}
+
+bool AStar3D::reserved(const Grid3& cell, float enter_time, float arrive_time) const {
+    // 轨迹插值时在离开上一个cell后即进入该cell，进入与到达两个时刻都需检查
+    int64_t enter_ms = this->_departure_ms + (int64_t)(enter_time * 1000);
+    int64_t arrive_ms = this->_departure_ms + (int64_t)(arrive_time * 1000);
+    return this->_reservations->conflicts(cell, enter_ms, this->_owner) ||
+           this->_reservations->conflicts(cell, arrive_ms, this->_owner);
+}
+
+bool AStar3D::in_range(const Grid3& cell) const {
+    return cell.x >= 0 && cell.x < this->_grid.size_x() && cell.y >= 0 &&
+           cell.y < this->_grid.size_y() && cell.z >= this->_z_min && cell.z <= this->_z_max;
+}
+
+double AStar3D::heuristic(int x, int y, int z, const Grid3& target) const {
+    int dx = std::abs(x - target.x);
+    int dy = std::abs(y - target.y);
+    int diagonal = std::min(dx, dy);
+    double cx = this->_grid.cell_size_x();
+    double cy = this->_grid.cell_size_y();
+    double horizontal = diagonal * std::hypot(cx, cy) + (dx - diagonal) * cx + (dy - diagonal) * cy;
+    double vertical = std::abs(z - target.z) *
+                      (this->_grid.cell_size_z() / this->_speed_v + this->_climb_penalty);
+    return horizontal / this->_speed_h + vertical;
+}
+
+std::vector<Grid3> AStar3D::find_path(Grid3 source, Grid3 target,
+                                      const std::vector<Grid3>& extra_collisions) {
+    this->_path_time = 0;
+    this->_expanded_nodes = 0;
+    if (!this->in_range(source) || !this->in_range(target)) {
+        return {};
+    }
+    int size_y = this->_grid.size_y();
+    int layers = this->_z_max - this->_z_min + 1;
+    auto index_of = [&](int x, int y, int z) {
+        return ((size_t)x * size_y + y) * layers + (z - this->_z_min);
+    };
+    size_t cell_num = (size_t)this->_grid.size_x() * size_y * layers;
+
+    // 按cell编号的稠密数组记录g值、父节点与状态，通过generation惰性重置
+    Workspace& ws = (this->_workspace != nullptr) ? *this->_workspace : this->_own_workspace;
+    if (ws.stamp.size() < cell_num) {
+        ws.g.resize(cell_num);
+        ws.time.resize(cell_num);
+        ws.leg_start.resize(cell_num);
+        ws.leg_length.resize(cell_num);
+        ws.parent.resize(cell_num);
+        ws.state.resize(cell_num);
+        ws.stamp.resize(cell_num, 0);
+    }
+    if (++ws.generation == 0) {
+        std::fill(ws.stamp.begin(), ws.stamp.end(), 0);
+        ws.generation = 1;
+    }
+    auto touch = [&ws](size_t i) {
+        if (ws.stamp[i] != ws.generation) {
+            ws.stamp[i] = ws.generation;
+            ws.g[i] = std::numeric_limits<float>::infinity();
+            ws.time[i] = 0;
+            ws.leg_start[i] = 0;
+            ws.leg_length[i] = 0;
+            ws.parent[i] = UINT32_MAX;
+            ws.state[i] = 0;
+        }
+    };
+    for (auto& cell : extra_collisions) {
+        if (this->in_range(cell)) {
+            size_t i = index_of(cell.x, cell.y, cell.z);
+            touch(i);
+            ws.state[i] = kBlocked;
+        }
+    }
+    size_t source_index = index_of(source.x, source.y, source.z);
+    size_t target_index = index_of(target.x, target.y, target.z);
+    touch(source_index);
+    touch(target_index);
+    // 起终点（如危险区域内的取货点、降落点）位于代价层的禁止区域时，与其连通的整个区域不受
+    // BLOCKED限制、附加代价按0计，与HierarchicalPlanner中Generator::removeCollision的处理一致
+    std::vector<size_t> opened;
+    if (this->_cost_layer != nullptr) {
+        for (const Grid3& endpoint : {source, target}) {
+            for (auto& c : this->_cost_layer->blockedRegion({endpoint.x, endpoint.y})) {
+                opened.push_back((size_t)c.x * size_y + c.y);
+            }
+        }
+        std::sort(opened.begin(), opened.end());
+    }
+    ws.state[source_index] = 0;
+    ws.state[target_index] = 0;
+
+    // 各方向一步的长度与代价（匀速飞行时间，升降附加惩罚）
+    double cx = this->_grid.cell_size_x();
+    double cy = this->_grid.cell_size_y();
+    double step_length[10];
+    double step_time[10];
+    for (int i = 0; i < 10; i++) {
+        const Grid3& m = kMoves[i];
+        if (m.z != 0) {
+            step_length[i] = this->_grid.cell_size_z();
+            step_time[i] = step_length[i] / this->_speed_v + this->_climb_penalty;
+        } else {
+            step_length[i] = std::hypot(m.x * cx, m.y * cy);
+            step_time[i] = step_length[i] / this->_speed_h;
+        }
+    }
+
+    using Entry = std::pair<float, uint32_t>;
+    auto& open = ws.open;
+    open.clear();
+    ws.g[source_index] = 0;
+    ws.time[source_index] = 0;
+    ws.leg_start[source_index] = 0;
+    ws.leg_length[source_index] = 0;
+    float source_h = this->heuristic(source.x, source.y, source.z, target);
+    open.push_back({source_h, (uint32_t)source_index});
+
+    bool found = false;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), std::greater<Entry>());
+        uint32_t current = open.back().second;
+        open.pop_back();
+        if (ws.state[current] & kClosed) {
+            continue;
+        }
+        ws.state[current] |= kClosed;
+        this->_expanded_nodes++;
+        if (current == target_index) {
+            found = true;
+            break;
+        }
+        int z = current % layers + this->_z_min;
+        int x = current / layers / size_y;
+        int y = current / layers % size_y;
+        // 进入current的方向，起点为{0, 0, 0}
+        Grid3 incoming = {0, 0, 0};
+        if (ws.parent[current] != UINT32_MAX) {
+            uint32_t p = ws.parent[current];
+            incoming = {x - (int)(p / layers / size_y), y - (int)(p / layers % size_y),
+                        z - (int)(p % layers) - this->_z_min};
+        }
+        for (int i = 0; i < 10; i++) {
+            Grid3 next = {x + kMoves[i].x, y + kMoves[i].y, z + kMoves[i].z};
+            if (!this->in_range(next) || this->_grid.occupied_unchecked(next.x, next.y, next.z)) {
+                continue;
+            }
+            size_t next_index = index_of(next.x, next.y, next.z);
+            touch(next_index);
+            if (ws.state[next_index] & (kClosed | kBlocked)) {
+                continue;
+            }
+            double cost = step_time[i];
+            if (this->_cost_layer != nullptr && kMoves[i].z == 0) {
+                uint8_t extra = this->_cost_layer->getCost({next.x, next.y});
+                if (extra == AStar::CostLayer::BLOCKED) {
+                    if (!std::binary_search(opened.begin(), opened.end(),
+                                            (size_t)next.x * size_y + next.y)) {
+                        continue;
+                    }
+                    extra = 0;
+                }
+                cost += step_time[i] * extra / 10.0;
+            }
+            float new_g = ws.g[current] + cost;
+            if (new_g < ws.g[next_index]) {
+                // 方向改变即开始新的航段：上一段在拐点减速到静止，新的一段从静止加速
+                const Grid3& m = kMoves[i];
+                float enter_time = ws.time[current];
+                float leg_start = ws.leg_start[current];
+                float leg_length = ws.leg_length[current];
+                if (m.x != incoming.x || m.y != incoming.y || m.z != incoming.z) {
+                    if (leg_length > 0) {
+                        leg_start += incoming.z != 0
+                                         ? leg_time(leg_length, this->_speed_v, this->_acc_v)
+                                         : leg_time(leg_length, this->_speed_h, this->_acc_h);
+                    }
+                    enter_time = leg_start;
+                    leg_length = 0;
+                }
+                leg_length += step_length[i];
+                float arrive_time =
+                    leg_start + (m.z != 0
+                                     ? leg_progress_time(leg_length, this->_speed_v, this->_acc_v)
+                                     : leg_progress_time(leg_length, this->_speed_h, this->_acc_h));
+                if (this->_reservations != nullptr && next_index != target_index &&
+                    this->reserved(next, enter_time, arrive_time)) {
+                    continue;
+                }
+                ws.g[next_index] = new_g;
+                ws.time[next_index] = arrive_time;
+                ws.leg_start[next_index] = leg_start;
+                ws.leg_length[next_index] = leg_length;
+                ws.parent[next_index] = current;
+                open.push_back({new_g + (float)this->heuristic(next.x, next.y, next.z, target),
+                                (uint32_t)next_index});
+                std::push_heap(open.begin(), open.end(), std::greater<Entry>());
+            }
+        }
+    }
+    if (!found) {
+        return {};
+    }
+
+    // 最后一段在终点减速到静止
+    uint32_t last = ws.parent[target_index];
+    bool last_vertical = last != UINT32_MAX && (int)(last % layers) + this->_z_min != target.z;
+    this->_path_time =
+        ws.leg_start[target_index] +
+        (last_vertical ? leg_time(ws.leg_length[target_index], this->_speed_v, this->_acc_v)
+                       : leg_time(ws.leg_length[target_index], this->_speed_h, this->_acc_h));
+    std::vector<Grid3> path;
+    for (uint32_t i = target_index; i != UINT32_MAX; i = ws.parent[i]) {
+        path.push_back({(int)(i / layers / size_y), (int)(i / layers % size_y),
+                        (int)(i % layers) + this->_z_min});
+    }
+    return path;
+}
+
+std::vector<Grid3> AStar3D::merge_corners(const std::vector<Grid3>& path,
+                                          const SegmentCollisionChecker& checker) const {
+    std::vector<Grid3> cells(path.rbegin(), path.rend());
+    if (cells.size() <= 2) {
+        return cells;
+    }
+    double cx = this->_grid.cell_size_x();
+    double cy = this->_grid.cell_size_y();
+    // 原路径的累计代价，只用于比较同一层上的两段，升降的代价按0计
+    std::vector<double> cost(cells.size(), 0);
+    for (size_t k = 1; k < cells.size(); k++) {
+        const Grid3& a = cells[k - 1];
+        const Grid3& b = cells[k];
+        double step = 0;
+        if (a.z == b.z) {
+            step = std::hypot((b.x - a.x) * cx, (b.y - a.y) * cy) / this->_speed_h;
+            if (this->_cost_layer != nullptr) {
+                step += step * this->_cost_layer->getCost({b.x, b.y}) / 10.0;
+            }
+        }
+        cost[k] = cost[k - 1] + step;
+    }
+    // 候选点为原路径的拐点，升降必然经过拐点，因此相邻候选点之间的路径都在同一层
+    std::vector<size_t> candidates = {0};
+    for (size_t k = 1; k + 1 < cells.size(); k++) {
+        const Grid3& a = cells[k - 1];
+        const Grid3& b = cells[k];
+        const Grid3& c = cells[k + 1];
+        if (sign(b.x - a.x) != sign(c.x - b.x) || sign(b.y - a.y) != sign(c.y - b.y) ||
+            sign(b.z - a.z) != sign(c.z - b.z)) {
+            candidates.push_back(k);
+        }
+    }
+    candidates.push_back(cells.size() - 1);
+
+    std::vector<Grid3> corners = {cells.front()};
+    size_t i = 0;
+    while (i + 1 < candidates.size()) {
+        size_t next = i + 1;
+        const Grid3& a = cells[candidates[i]];
+        for (size_t j = i + 2; j < candidates.size() && cells[candidates[j]].z == a.z; j++) {
+            const Grid3& b = cells[candidates[j]];
+            uint32_t extra = 0;
+            int cell_num = 0;
+            if (!checker.line_of_sight(a.x, a.y, b.x, b.y, a.z, &extra, &cell_num)) {
+                continue;
+            }
+            // 直线段按沿途cell的平均附加代价放大，与AStar::Generator::smoothPath一致
+            double leg = std::hypot((b.x - a.x) * cx, (b.y - a.y) * cy) / this->_speed_h;
+            if (this->_cost_layer != nullptr && cell_num > 0) {
+                leg += leg * extra / cell_num / 10.0;
+            }
+            if (leg <= cost[candidates[j]] - cost[candidates[i]] + 1e-6) {
+                next = j;
+            }
+        }
+        corners.push_back(cells[candidates[next]]);
+        i = next;
+    }
+    return corners;
+}
+
+std::vector<Grid3> AStar3D::corner_points(const std::vector<Grid3>& path) {
+    std::vector<Grid3> result(path.rbegin(), path.rend());
+    if (result.size() <= 2) {
+        return result;
+    }
+    std::vector<Grid3> corners;
+    corners.push_back(result.front());
+    for (size_t i = 1; i + 1 < result.size(); i++) {
+        const Grid3& a = result[i - 1];
+        const Grid3& b = result[i];
+        const Grid3& c = result[i + 1];
+        if (sign(b.x - a.x) != sign(c.x - b.x) || sign(b.y - a.y) != sign(c.y - b.y) ||
+            sign(b.z - a.z) != sign(c.z - b.z)) {
+            corners.push_back(b);
+        }
+    }
+    corners.push_back(result.back());
+    return corners;
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,26 @@
+#include "collision_layer.h"
+
+namespace mtuav::algorithm {
+
+void CollisionLayerSet::build(const OccupancyGrid& grid) {
+    this->_layers.clear();
+    for (int z = 0; z < grid.size_z(); z++) {
+        this->_layers.emplace_back(AStar::Vec2i{grid.size_x(), grid.size_y()});
+    }
+    // 按z列遍历一次网格，将每一位分发到对应的层
+    for (int x = 0; x < grid.size_x(); x++) {
+        for (int y = 0; y < grid.size_y(); y++) {
+            const uint64_t* column = grid.column(x, y);
+            for (int w = 0; w < grid.words_per_column(); w++) {
+                uint64_t word = column[w];
+                while (word != 0) {
+                    int z = w * 64 + __builtin_ctzll(word);
+                    word &= word - 1;
+                    this->_layers[z].set({x, y});
+                }
+            }
+        }
+    }
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,136 @@
+#include "distance_field.h"
+#include <algorithm>
+
+namespace mtuav::algorithm {
+
+namespace {
+const uint8_t kSettled = 1;
+const uint8_t kTarget = 2;
+
+// 8邻域，顺序与AStar::Generator一致，前4个为直行
+const AStar::Vec2i kMoves[8] = {
+    {0, 1}, {1, 0}, {0, -1}, {-1, 0}, {-1, -1}, {1, 1}, {-1, 1}, {1, -1},
+};
+}  // namespace
+
+DistanceField::DistanceField(const OccupancyGrid& grid, const AStar::CollisionLayer* layer)
+    : _layer(layer),
+      _size_x(grid.size_x()),
+      _size_y(grid.size_y()),
+      _cell_size(grid.cell_size_x()) {
+    size_t cell_num = (size_t)this->_size_x * this->_size_y;
+    this->_cost.resize(cell_num);
+    this->_stamp.resize(cell_num, 0);
+    this->_state.resize(cell_num);
+}
+
+bool DistanceField::in_range(AStar::Vec2i cell) const {
+    return cell.x >= 0 && cell.x < this->_size_x && cell.y >= 0 && cell.y < this->_size_y;
+}
+
+void DistanceField::touch(size_t i) {
+    if (this->_stamp[i] != this->_generation) {
+        this->_stamp[i] = this->_generation;
+        this->_cost[i] = UNREACHABLE;
+        this->_state[i] = 0;
+    }
+}
+
+void DistanceField::compute(AStar::Vec2i source, const AStar::CoordinateList& targets) {
+    if (++this->_generation == 0) {
+        std::fill(this->_stamp.begin(), this->_stamp.end(), 0);
+        this->_generation = 1;
+    }
+    this->_settled_cells = 0;
+    if (this->_layer == nullptr || !this->in_range(source)) {
+        return;
+    }
+
+    // 记录尚未确定距离的目标数，为0时提前结束；重复的目标只计一次
+    int remaining = 0;
+    for (auto& target : targets) {
+        if (!this->in_range(target)) {
+            continue;
+        }
+        size_t i = this->index_of(target);
+        this->touch(i);
+        if (!(this->_state[i] & kTarget)) {
+            this->_state[i] |= kTarget;
+            remaining++;
+        }
+    }
+    bool all_cells = targets.empty();
+
+    // 边权只有10和14，使用15个桶的循环桶队列（Dial算法）代替堆：代价为c的cell放在第c%15个桶中，
+    // 任意时刻队列中的代价都在[c, c+14]内，按代价递增依次取桶即可，入队出队均为O(1)
+    for (auto& bucket : this->_buckets) {
+        bucket.clear();
+    }
+    size_t source_index = this->index_of(source);
+    this->touch(source_index);
+    this->_cost[source_index] = 0;
+    this->_buckets[0].push_back(source_index);
+    size_t queued = 1;
+
+    for (uint32_t cost = 0; queued > 0 && (all_cells || remaining > 0); cost++) {
+        auto& bucket = this->_buckets[cost % kBucketNum];
+        // 扩展过程中只会向其他桶追加，按下标遍历即可
+        for (size_t k = 0; k < bucket.size() && (all_cells || remaining > 0); k++) {
+            uint32_t current = bucket[k];
+            queued--;
+            if ((this->_state[current] & kSettled) || this->_cost[current] != cost) {
+                continue;
+            }
+            this->_state[current] |= kSettled;
+            this->_settled_cells++;
+            AStar::Vec2i coordinates = {(int)(current / this->_size_y),
+                                        (int)(current % this->_size_y)};
+            if (this->_state[current] & kTarget) {
+                remaining--;
+                // 被占据的目标只作为终点，不从它继续扩展
+                if (current != source_index && this->_layer->isBlocked(coordinates)) {
+                    continue;
+                }
+            }
+            for (int i = 0; i < 8; i++) {
+                AStar::Vec2i next = coordinates + kMoves[i];
+                if (!this->in_range(next)) {
+                    continue;
+                }
+                size_t next_index = this->index_of(next);
+                this->touch(next_index);
+                if (this->_state[next_index] & kSettled) {
+                    continue;
+                }
+                if (!(this->_state[next_index] & kTarget) && this->_layer->isBlocked(next)) {
+                    continue;
+                }
+                uint32_t next_cost = cost + (i < 4 ? 10 : 14);
+                if (next_cost < this->_cost[next_index]) {
+                    this->_cost[next_index] = next_cost;
+                    this->_buckets[next_cost % kBucketNum].push_back(next_index);
+                    queued++;
+                }
+            }
+        }
+        bucket.clear();
+    }
+}
+
+uint32_t DistanceField::cost(AStar::Vec2i cell) const {
+    if (!this->in_range(cell)) {
+        return UNREACHABLE;
+    }
+    size_t i = this->index_of(cell);
+    if (this->_stamp[i] != this->_generation || !(this->_state[i] & kSettled)) {
+        return UNREACHABLE;
+    }
+    return this->_cost[i];
+}
+
+double DistanceField::distance(AStar::Vec2i cell) const {
+    uint32_t c = this->cost(cell);
+    return c == UNREACHABLE ? -1.0 : c / 10.0 * this->_cell_size;
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,266 @@
+#include "dstar_lite.h"
+#include <algorithm>
+#include "AStarEngine.h"
+
+namespace mtuav::algorithm {
+
+namespace {
+using Neighborhood = AStar::policy::EightConnected;
+
+uint32_t add_cost(uint32_t a, uint32_t b) {
+    return (a == DStarLite::INF || b == DStarLite::INF) ? DStarLite::INF : a + b;
+}
+}  // namespace
+
+void DStarLite::reset(const AStar::CollisionLayer* collision_layer,
+                      const AStar::CostLayer* cost_layer, AStar::Vec2i goal,
+                      const AStar::LandmarkTable* landmarks) {
+    this->_collision_layer = collision_layer;
+    this->_cost_layer = cost_layer;
+    this->_landmarks = landmarks;
+    this->_goal = goal;
+    this->_start = goal;
+    this->_last_start = goal;
+    this->_km = 0;
+    this->_open = decltype(this->_open)();
+    this->_wall_cells.clear();
+    if (collision_layer == nullptr) {
+        this->_size = {0, 0};
+        this->_g.clear();
+        this->_rhs.clear();
+        return;
+    }
+    this->_size = collision_layer->getSize();
+    size_t cell_num = (size_t)this->_size.x * this->_size.y;
+    this->_g.assign(cell_num, INF);
+    this->_rhs.assign(cell_num, INF);
+    this->_walls = AStar::CollisionLayer(this->_size);
+    this->_openings = AStar::CollisionLayer(this->_size);
+    if (goal.x < 0 || goal.x >= this->_size.x || goal.y < 0 || goal.y >= this->_size.y) {
+        return;  // 终点在地图外，find_path始终返回空
+    }
+    this->_openings.set(goal);
+    size_t goal_cell = this->index(goal);
+    this->_rhs[goal_cell] = 0;
+    this->_open.push({this->calculate_key(goal_cell), (uint32_t)goal_cell});
+}
+
+bool DStarLite::matches(const AStar::CollisionLayer* collision_layer,
+                        const AStar::CostLayer* cost_layer, AStar::Vec2i goal,
+                        const AStar::LandmarkTable* landmarks) const {
+    return this->_collision_layer != nullptr && this->_collision_layer == collision_layer &&
+           this->_cost_layer == cost_layer && this->_landmarks == landmarks &&
+           this->_goal.x == goal.x && this->_goal.y == goal.y;
+}
+
+uint32_t DStarLite::edge_cost(AStar::Vec2i to, int direction) const {
+    AStar::GridView grid = {this->_size, &this->_walls, &this->_openings, this->_collision_layer,
+                            this->_cost_layer};
+    if (grid.isBlocked(to)) {
+        return INF;
+    }
+    if (this->_cost_layer != nullptr) {
+        return AStar::policy::LayerCost()(grid, to, direction);
+    }
+    return AStar::policy::UniformCost()(grid, to, direction);
+}
+
+uint32_t DStarLite::step_cost(AStar::Vec2i to, int direction) const {
+    AStar::GridView grid = {this->_size, &this->_walls, &this->_openings, this->_collision_layer,
+                            this->_cost_layer};
+    if (this->_cost_layer != nullptr) {
+        return AStar::policy::LayerCost()(grid, to, direction);
+    }
+    return AStar::policy::UniformCost()(grid, to, direction);
+}
+
+uint32_t DStarLite::heuristic(AStar::Vec2i a, AStar::Vec2i b) const {
+    // ALT下界由不含临时障碍与代价层的距离得到，边权只增不减，仍是一致的下界
+    if (this->_landmarks != nullptr) {
+        return AStar::policy::Landmark<AStar::policy::Octagonal>{this->_landmarks, {}}(a, b);
+    }
+    return AStar::policy::Octagonal()(a, b);
+}
+
+DStarLite::Key DStarLite::calculate_key(size_t cell) const {
+    uint32_t m = std::min(this->_g[cell], this->_rhs[cell]);
+    if (m == INF) {
+        return {INF, INF};
+    }
+    return {m + this->heuristic(this->_start, this->coordinates(cell)) + this->_km, m};
+}
+
+void DStarLite::update_vertex(size_t cell) {
+    AStar::Vec2i c = this->coordinates(cell);
+    if (!(c == this->_goal)) {
+        uint32_t best = INF;
+        for (uint32_t i = 0; i < Neighborhood::count; i++) {
+            AStar::Vec2i next = c + Neighborhood::offset(i);
+            if (next.x < 0 || next.x >= this->_size.x || next.y < 0 || next.y >= this->_size.y) {
+                continue;
+            }
+            best = std::min(best, add_cost(this->edge_cost(next, i), this->_g[this->index(next)]));
+        }
+        this->_rhs[cell] = best;
+    }
+    if (this->_g[cell] != this->_rhs[cell]) {
+        this->_open.push({this->calculate_key(cell), (uint32_t)cell});
+    }
+}
+
+void DStarLite::on_cost_decreased(AStar::Vec2i c) {
+    uint32_t g = this->_g[this->index(c)];
+    for (uint32_t i = 0; i < Neighborhood::count; i++) {
+        AStar::Vec2i prev = c + Neighborhood::offset(i);
+        if (prev.x < 0 || prev.x >= this->_size.x || prev.y < 0 || prev.y >= this->_size.y ||
+            prev == this->_goal) {
+            continue;
+        }
+        // 前驱到c与c到前驱同为直行或对角
+        size_t p = this->index(prev);
+        uint32_t cost = add_cost(this->edge_cost(c, i), g);
+        if (cost < this->_rhs[p]) {
+            this->_rhs[p] = cost;
+            if (this->_g[p] != this->_rhs[p]) {
+                this->_open.push({this->calculate_key(p), (uint32_t)p});
+            }
+        }
+    }
+}
+
+void DStarLite::on_cost_increased(AStar::Vec2i c, uint32_t old_g, bool was_open) {
+    for (uint32_t i = 0; i < Neighborhood::count; i++) {
+        AStar::Vec2i prev = c + Neighborhood::offset(i);
+        if (prev.x < 0 || prev.x >= this->_size.x || prev.y < 0 || prev.y >= this->_size.y ||
+            prev == this->_goal) {
+            continue;
+        }
+        uint32_t old_cost = was_open ? this->step_cost(c, i) : this->edge_cost(c, i);
+        if (this->_rhs[this->index(prev)] == add_cost(old_cost, old_g)) {
+            this->update_vertex(this->index(prev));
+        }
+    }
+}
+
+void DStarLite::compute_shortest_path() {
+    size_t start = this->index(this->_start);
+    // 优先队列不支持删除与修改，键值变化时重新入队，出队时跳过已一致或键值过期的旧项
+    while (!this->_open.empty()) {
+        Entry top = this->_open.top();
+        size_t u = top.cell;
+        if (this->_g[u] == this->_rhs[u]) {
+            this->_open.pop();
+            continue;
+        }
+        Key key = this->calculate_key(u);
+        if (key < top.key) {
+            this->_open.pop();  // 之后以更小的键值重新入队过
+            continue;
+        }
+        if (!(top.key < this->calculate_key(start)) && this->_rhs[start] == this->_g[start]) {
+            break;
+        }
+        this->_open.pop();
+        if (top.key < key) {
+            // 起点移动后km增大，按新的键值重新排序
+            this->_open.push({key, (uint32_t)u});
+            continue;
+        }
+        this->_expanded_nodes++;
+        AStar::Vec2i c = this->coordinates(u);
+        if (this->_g[u] > this->_rhs[u]) {
+            this->_g[u] = this->_rhs[u];
+            this->on_cost_decreased(c);
+        } else {
+            uint32_t old_g = this->_g[u];
+            this->_g[u] = INF;
+            this->on_cost_increased(c, old_g, false);
+            this->update_vertex(u);
+        }
+    }
+}
+
+int DStarLite::apply_obstacles(const AStar::CoordinateList& obstacles) {
+    AStar::CollisionLayer previous = this->_walls;
+    std::vector<uint32_t> previous_cells;
+    previous_cells.swap(this->_wall_cells);
+    this->_walls.clear();
+    for (AStar::Vec2i c : obstacles) {
+        if (c.x < 0 || c.x >= this->_size.x || c.y < 0 || c.y >= this->_size.y ||
+            c == this->_goal || c == this->_start || this->_walls.isBlocked(c)) {
+            continue;
+        }
+        this->_walls.set(c);
+        this->_wall_cells.push_back(this->index(c));
+    }
+
+    // 可通行性变化的cell只影响进入它的边，即各邻居的rhs
+    int changed = 0;
+    for (uint32_t cell : previous_cells) {
+        AStar::Vec2i c = this->coordinates(cell);
+        if (!this->_walls.isBlocked(c)) {
+            this->on_cost_decreased(c);
+            changed++;
+        }
+    }
+    for (uint32_t cell : this->_wall_cells) {
+        AStar::Vec2i c = this->coordinates(cell);
+        if (!previous.isBlocked(c)) {
+            this->on_cost_increased(c, this->_g[cell], true);
+            changed++;
+        }
+    }
+    return changed;
+}
+
+AStar::CoordinateList DStarLite::find_path(AStar::Vec2i start,
+                                           const AStar::CoordinateList& obstacles) {
+    this->_expanded_nodes = 0;
+    this->_changed_cells = 0;
+    if (this->_g.empty() || start.x < 0 || start.x >= this->_size.x || start.y < 0 ||
+        start.y >= this->_size.y) {
+        return {};
+    }
+    // 起点移动后所有键值中的启发项至多减小h(上一个起点, 起点)，累加到km上保持键值可比
+    this->_start = start;
+    this->_km += this->heuristic(this->_last_start, start);
+    this->_last_start = start;
+    this->_changed_cells = this->apply_obstacles(obstacles);
+    this->compute_shortest_path();
+
+    size_t start_cell = this->index(start);
+    if (this->_g[start_cell] == INF) {
+        return {};
+    }
+    // 沿c(u, v) + g(v)最小的方向走到终点
+    AStar::CoordinateList path = {start};
+    AStar::Vec2i c = start;
+    size_t max_steps = this->_g.size();
+    while (!(c == this->_goal) && path.size() <= max_steps) {
+        uint32_t best = INF;
+        AStar::Vec2i best_next = c;
+        for (uint32_t i = 0; i < Neighborhood::count; i++) {
+            AStar::Vec2i next = c + Neighborhood::offset(i);
+            if (next.x < 0 || next.x >= this->_size.x || next.y < 0 || next.y >= this->_size.y) {
+                continue;
+            }
+            uint32_t cost = add_cost(this->edge_cost(next, i), this->_g[this->index(next)]);
+            if (cost < best) {
+                best = cost;
+                best_next = next;
+            }
+        }
+        if (best == INF) {
+            return {};
+        }
+        c = best_next;
+        path.push_back(c);
+    }
+    if (!(c == this->_goal)) {
+        return {};
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+}  // namespace mtuav::algorithm
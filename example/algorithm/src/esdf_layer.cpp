@@ -0,0 +1,161 @@
+#include "esdf_layer.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <thread>
+
+namespace mtuav::algorithm {
+
+EsdfLayer::EsdfLayer(double altitude, float origin_x, float origin_y, float resolution,
+                     int size_x, int size_y)
+    : _altitude(altitude),
+      _origin_x(origin_x),
+      _origin_y(origin_y),
+      _resolution(resolution),
+      _inv_resolution(1.0f / resolution),
+      _size_x(size_x),
+      _size_y(size_y),
+      _distance((size_t)size_x * size_y, 0.0f) {}
+
+float EsdfLayer::interpolate(double x, double y) const {
+    float out;
+    float fx = x, fy = y;
+    this->interpolate_batch(&fx, &fy, 1, &out);
+    return out;
+}
+
+void EsdfLayer::interpolate_batch(const float* xs, const float* ys, int n, float* out) const {
+    const float max_u = _size_x - 1;
+    const float max_v = _size_y - 1;
+    const float* d = _distance.data();
+    for (int k = 0; k < n; k++) {
+        float u = std::min(std::max((xs[k] - _origin_x) * _inv_resolution, 0.0f), max_u);
+        float v = std::min(std::max((ys[k] - _origin_y) * _inv_resolution, 0.0f), max_v);
+        // 右上角采样点取不越界的索引，边界上的权重为0
+        int i0 = std::min((int)u, _size_x - 2);
+        int j0 = std::min((int)v, _size_y - 2);
+        float tu = u - i0;
+        float tv = v - j0;
+        const float* row0 = d + (size_t)i0 * _size_y + j0;
+        const float* row1 = row0 + _size_y;
+        float d0 = row0[0] + (row0[1] - row0[0]) * tv;
+        float d1 = row1[0] + (row1[1] - row1[0]) * tv;
+        out[k] = d0 + (d1 - d0) * tu;
+    }
+}
+
+void EsdfLayerCache::build(std::shared_ptr<Map> map, const std::vector<double>& altitudes,
+                           float resolution, const GridCache* cache, uint64_t key) {
+    auto start_time = std::chrono::steady_clock::now();
+    float min_x, min_y, min_z, max_x, max_y, max_z;
+    map->Range(&min_x, &max_x, &min_y, &max_y, &min_z, &max_z);
+    // 至少2x2个采样点，保证双线性插值有意义
+    int size_x = std::max(2, (int)((max_x - min_x) / resolution) + 1);
+    int size_y = std::max(2, (int)((max_y - min_y) / resolution) + 1);
+
+    this->_layers.clear();
+    for (double altitude : altitudes) {
+        this->_layers.emplace_back(altitude, min_x, min_y, resolution, size_x, size_y);
+    }
+    // 缓存文件按高度与采样间隔（厘米）区分
+    auto suffix = [resolution](const EsdfLayer& layer) {
+        return "esdf" + std::to_string(std::lround(layer.altitude())) + "_" +
+               std::to_string(std::lround(resolution * 100));
+    };
+    // 每个未命中缓存的高度层一个线程，各线程写入各自的数组
+    std::vector<EsdfLayer*> missed;
+    for (auto& layer : this->_layers) {
+        if (cache == nullptr ||
+            !cache->load_data(key, suffix(layer), layer.data(), layer.data_bytes())) {
+            missed.push_back(&layer);
+        }
+    }
+    std::vector<std::thread> workers;
+    for (EsdfLayer* layer : missed) {
+        workers.emplace_back([&map, layer]() {
+            for (int i = 0; i < layer->size_x(); i++) {
+                for (int j = 0; j < layer->size_y(); j++) {
+                    const Voxel* voxel =
+                        map->Query(layer->sample_x(i), layer->sample_y(j), layer->altitude());
+                    layer->at(i, j) =
+                        (voxel != nullptr) ? voxel->distance : EsdfLayer::kFreeDistance;
+                }
+            }
+        });
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+    if (cache != nullptr) {
+        for (EsdfLayer* layer : missed) {
+            cache->save_data(key, suffix(*layer), layer->data(), layer->data_bytes());
+        }
+    }
+    auto end_time = std::chrono::steady_clock::now();
+    LOG(INFO) << "距离层构建完毕，层数: " << this->_layers.size()
+              << ", 采样层数: " << missed.size() << ", 每层采样: " << size_x
+              << " x " << size_y << ", 耗时: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time)
+                     .count()
+              << " ms";
+}
+
+const EsdfLayer* EsdfLayerCache::layer(double altitude, double tolerance) const {
+    const EsdfLayer* best = nullptr;
+    double best_diff = tolerance;
+    for (auto& layer : this->_layers) {
+        double diff = std::fabs(layer.altitude() - altitude);
+        if (diff <= best_diff) {
+            best = &layer;
+            best_diff = diff;
+        }
+    }
+    return best;
+}
+
+bool EsdfLayerCache::clearance(const Vec3& p, float* distance) const {
+    const EsdfLayer* layer = this->layer(p.z);
+    if (layer == nullptr) {
+        return false;
+    }
+    *distance = layer->interpolate(p.x, p.y);
+    return true;
+}
+
+bool EsdfLayerCache::min_clearance(const std::vector<Segment>& segments, float* distance) const {
+    const int kBatch = 64;
+    float xs[kBatch], ys[kBatch], ds[kBatch];
+    float result = std::numeric_limits<float>::infinity();
+    bool found = false;
+    size_t i = 0;
+    while (i < segments.size()) {
+        const EsdfLayer* layer = this->layer(segments[i].position.z);
+        if (layer == nullptr) {
+            i++;
+            continue;
+        }
+        // 收集同一高度层上连续的点，批量插值
+        int n = 0;
+        while (i < segments.size() && n < kBatch &&
+               std::fabs(segments[i].position.z - layer->altitude()) <= 1.0) {
+            xs[n] = segments[i].position.x;
+            ys[n] = segments[i].position.y;
+            n++;
+            i++;
+        }
+        layer->interpolate_batch(xs, ys, n, ds);
+        for (int k = 0; k < n; k++) {
+            result = std::min(result, ds[k]);
+        }
+        found = true;
+    }
+    if (found) {
+        *distance = result;
+    }
+    return found;
+}
+
+}  // namespace mtuav::algorithm
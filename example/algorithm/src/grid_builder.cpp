@@ -0,0 +1,185 @@
+#include "grid_builder.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace mtuav::algorithm {
+
+GridBuilder::GridBuilder(std::shared_ptr<Map> map, int cell_size_x, int cell_size_y,
+                         int cell_size_z)
+    : _map(std::move(map)),
+      _cell_size_x(cell_size_x),
+      _cell_size_y(cell_size_y),
+      _cell_size_z(cell_size_z) {}
+
+void GridBuilder::set_thread_num(int thread_num) { this->_thread_num = thread_num; }
+
+void GridBuilder::set_tile_size(int tile_x, int tile_y) {
+    this->_tile_x = std::max(1, tile_x);
+    this->_tile_y = std::max(1, tile_y);
+}
+
+void GridBuilder::set_distance_skipping(bool enable) { this->_distance_skipping = enable; }
+
+OccupancyGrid GridBuilder::build() {
+    auto start_time = std::chrono::steady_clock::now();
+
+    float min_x, min_y, min_z, max_x, max_y, max_z;
+    this->_map->Range(&min_x, &max_x, &min_y, &max_y, &min_z, &max_z);
+    int grid_n_x = (int)((max_x - min_x) / this->_cell_size_x);
+    int grid_n_y = (int)((max_y - min_y) / this->_cell_size_y);
+    int grid_n_z = (int)((max_z - min_z) / this->_cell_size_z);
+    OccupancyGrid grid(grid_n_x, grid_n_y, grid_n_z, min_x, min_y, min_z, this->_cell_size_x,
+                       this->_cell_size_y, this->_cell_size_z);
+    // 已确定占据状态的cell
+    OccupancyGrid visited(grid_n_x, grid_n_y, grid_n_z, min_x, min_y, min_z, this->_cell_size_x,
+                          this->_cell_size_y, this->_cell_size_z);
+
+    // 切分tile
+    std::vector<Tile> tiles;
+    for (int x = 0; x < grid_n_x; x += this->_tile_x) {
+        for (int y = 0; y < grid_n_y; y += this->_tile_y) {
+            tiles.push_back({x, std::min(x + this->_tile_x, grid_n_x), y,
+                             std::min(y + this->_tile_y, grid_n_y)});
+        }
+    }
+
+    int thread_num = this->_thread_num;
+    if (thread_num <= 0) {
+        thread_num = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_num = std::max(1, std::min(thread_num, (int)tiles.size()));
+
+    LOG(INFO) << "网格尺寸: " << grid_n_x << " x " << grid_n_y << " x " << grid_n_z
+              << ", tile数量: " << tiles.size() << ", 线程数: " << thread_num;
+
+    this->_next_tile = 0;
+    this->_finished_tiles = 0;
+    this->_query_count = 0;
+    this->_skipped_count = 0;
+    // 各线程写入的z列互不重叠（每列独占整数个word，球形标记也不越出tile），无需加锁
+    std::vector<std::thread> workers;
+    for (int i = 1; i < thread_num; i++) {
+        workers.emplace_back(&GridBuilder::worker, this, std::cref(tiles), std::ref(grid),
+                             std::ref(visited));
+    }
+    this->worker(tiles, grid, visited);  // 主线程也参与计算
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    this->_stats.query_count = this->_query_count;
+    this->_stats.skipped_count = this->_skipped_count;
+    this->_stats.tile_count = tiles.size();
+    this->_stats.thread_num = thread_num;
+    this->_stats.elapsed_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+    LOG(INFO) << "网格构建耗时: " << this->_stats.elapsed_ms
+              << " ms, Query次数: " << this->_stats.query_count
+              << ", 距离场跳过cell数: " << this->_stats.skipped_count;
+    return grid;
+}
+
+void GridBuilder::worker(const std::vector<Tile>& tiles, OccupancyGrid& grid,
+                         OccupancyGrid& visited) {
+    int tile_num = tiles.size();
+    while (true) {
+        int idx = this->_next_tile.fetch_add(1);
+        if (idx >= tile_num) {
+            break;
+        }
+        this->_query_count += this->fill_tile(tiles[idx], grid, visited);
+        // 每完成10%打印一次进度
+        int finished = ++this->_finished_tiles;
+        if (finished * 10 / tile_num != (finished - 1) * 10 / tile_num) {
+            LOG(INFO) << "网格计算进度: " << finished * 100 / tile_num << "% (" << finished << "/"
+                      << tile_num << ")";
+        }
+    }
+}
+
+int64_t GridBuilder::fill_tile(const Tile& tile, OccupancyGrid& grid, OccupancyGrid& visited) {
+    int64_t query_count = 0;
+    int64_t skipped_count = 0;
+    float half_cell = 0.5 * this->_cell_size_x;
+    for (int x = tile.x_begin; x < tile.x_end; x++) {
+        for (int y = tile.y_begin; y < tile.y_end; y++) {
+            for (int z = 0; z < grid.size_z(); z++) {
+                if (visited.occupied_unchecked(x, y, z)) {
+                    continue;  // 已由之前的查询推断出
+                }
+                // 每个cell的中心点坐标
+                Vec3 mid = grid.cell_center(x, y, z);
+                const Voxel* voxel = this->_map->Query(mid.x, mid.y, mid.z);
+                query_count++;
+                visited.set(x, y, z, true);
+                if (voxel == nullptr) {
+                    continue;
+                }
+                bool occupied = voxel->distance <= half_cell;
+                if (occupied) {
+                    grid.set(x, y, z, true);  // 有障碍物
+                }
+                if (!this->_distance_skipping) {
+                    continue;
+                }
+                // 距离场满足|d(p) - d(q)| <= |p - q|：
+                // 无障碍时，|p - q| < d(p) - half_cell 内的cell必然无障碍
+                // 有障碍时，|p - q| <= half_cell - d(p) 内的cell必然有障碍
+                float radius = occupied ? half_cell - voxel->distance : voxel->distance - half_cell;
+                if (radius >= this->_cell_size_x || radius >= this->_cell_size_y ||
+                    radius >= this->_cell_size_z) {
+                    skipped_count +=
+                        this->mark_sphere(tile, x, y, z, radius, occupied, grid, visited);
+                }
+            }
+        }
+    }
+    this->_skipped_count += skipped_count;
+    return query_count;
+}
+
+int64_t GridBuilder::mark_sphere(const Tile& tile, int x, int y, int z, float radius,
+                                 bool occupied, OccupancyGrid& grid, OccupancyGrid& visited) {
+    int64_t marked = 0;
+    float r2 = radius * radius;
+    int rx = (int)(radius / this->_cell_size_x);
+    int ry = (int)(radius / this->_cell_size_y);
+    int rz = (int)(radius / this->_cell_size_z);
+    int x_begin = std::max(tile.x_begin, x - rx), x_end = std::min(tile.x_end - 1, x + rx);
+    int y_begin = std::max(tile.y_begin, y - ry), y_end = std::min(tile.y_end - 1, y + ry);
+    for (int i = x_begin; i <= x_end; i++) {
+        float dx = (i - x) * this->_cell_size_x;
+        for (int j = y_begin; j <= y_end; j++) {
+            float dy = (j - y) * this->_cell_size_y;
+            float rest = r2 - dx * dx - dy * dy;
+            if (rest < 0) {
+                continue;
+            }
+            // 该列上落在球内的z范围
+            int dz_max = std::min(rz, (int)(std::sqrt(rest) / this->_cell_size_z));
+            int k_begin = std::max(0, z - dz_max), k_end = std::min(grid.size_z() - 1, z + dz_max);
+            for (int k = k_begin; k <= k_end; k++) {
+                float dz = (k - z) * this->_cell_size_z;
+                // 无障碍时要求严格小于半径
+                if (!occupied && dx * dx + dy * dy + dz * dz >= r2) {
+                    continue;
+                }
+                if (visited.occupied_unchecked(i, j, k)) {
+                    continue;
+                }
+                visited.set(i, j, k, true);
+                if (occupied) {
+                    grid.set(i, j, k, true);
+                }
+                marked++;
+            }
+        }
+    }
+    return marked;
+}
+
+}  // namespace mtuav::algorithm
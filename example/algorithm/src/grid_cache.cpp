@@ -0,0 +1,257 @@
+#include "grid_cache.h"
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace mtuav::algorithm {
+
+namespace {
+const char kMagic[8] = {'M', 'T', 'G', 'R', 'I', 'D', '\0', '\0'};
+const uint32_t kVersion = 1;
+// 文件头长度，取cache line的整数倍，保证mmap后网格数据64字节对齐
+const size_t kHeaderBytes = 128;
+
+struct GridCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+    uint64_t key;
+    int32_t size_x;
+    int32_t size_y;
+    int32_t size_z;
+    int32_t words_per_column;
+    float origin_x;
+    float origin_y;
+    float origin_z;
+    float cell_size_x;
+    float cell_size_y;
+    float cell_size_z;
+    uint64_t word_count;
+};
+static_assert(sizeof(GridCacheHeader) <= kHeaderBytes, "grid cache header too large");
+
+const char kDataMagic[8] = {'M', 'T', 'D', 'A', 'T', 'A', '\0', '\0'};
+const uint32_t kDataVersion = 1;
+
+struct DataCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t key;
+    uint64_t bytes;
+};
+
+// FNV-1a 64位哈希
+uint64_t fnv1a(const std::string& str) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : str) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 读取地图目录下meta_data.pb.txt中的包围盒与分辨率
+std::string read_map_meta(const std::string& map_path) {
+    size_t pos = map_path.find_last_of('/');
+    std::string dir = (pos == std::string::npos) ? "." : map_path.substr(0, pos);
+    std::ifstream fin(dir + "/meta_data.pb.txt");
+    if (!fin.is_open()) {
+        return "";
+    }
+    const char* keys[] = {"min_x:", "min_y:", "min_z:", "max_x:",      "max_y:",
+                          "max_z:", "resolution:", "resolution_high:", "map_version:"};
+    std::string meta;
+    std::string line;
+    while (std::getline(fin, line)) {
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos) {
+            continue;
+        }
+        for (const char* key : keys) {
+            if (line.compare(begin, std::strlen(key), key) == 0) {
+                meta += line.substr(begin) + ";";
+                break;
+            }
+        }
+    }
+    return meta;
+}
+}  // namespace
+
+GridCache::GridCache(std::string cache_dir) : _cache_dir(std::move(cache_dir)) {}
+
+uint64_t GridCache::make_key(const std::string& map_path, Map* map, int cell_size_x,
+                             int cell_size_y, int cell_size_z) {
+    std::ostringstream desc;
+    desc << "path=" << map_path << ";";
+    struct stat st;
+    if (stat(map_path.c_str(), &st) == 0) {
+        desc << "size=" << st.st_size << ";mtime=" << st.st_mtime << ";";
+    }
+    float min_x, min_y, min_z, max_x, max_y, max_z;
+    map->Range(&min_x, &max_x, &min_y, &max_y, &min_z, &max_z);
+    desc << "range=" << min_x << "," << max_x << "," << min_y << "," << max_y << "," << min_z
+         << "," << max_z << ";";
+    desc << "meta=" << read_map_meta(map_path);
+    desc << "cell=" << cell_size_x << "," << cell_size_y << "," << cell_size_z << ";";
+    desc << "version=" << kVersion;
+    return fnv1a(desc.str());
+}
+
+std::string GridCache::cache_path(uint64_t key, const std::string& suffix) const {
+    char name[64];
+    snprintf(name, sizeof(name), "/%016llx.%s", (unsigned long long)key, suffix.c_str());
+    return this->_cache_dir + name;
+}
+
+bool GridCache::load(uint64_t key, OccupancyGrid& grid) const {
+    std::string path = this->cache_path(key);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < kHeaderBytes) {
+        close(fd);
+        return false;
+    }
+    size_t file_bytes = st.st_size;
+    // 私有映射：网格被修改时只会写时复制，不会改动缓存文件
+    void* base = mmap(nullptr, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG(INFO) << "网格缓存mmap失败: " << path;
+        return false;
+    }
+
+    GridCacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    bool valid = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 &&
+                 header.version == kVersion && header.header_bytes == kHeaderBytes &&
+                 header.key == key && header.size_x > 0 && header.size_y > 0 &&
+                 header.size_z > 0 &&
+                 header.words_per_column == OccupancyGrid::column_words(header.size_z) &&
+                 header.word_count ==
+                     (uint64_t)header.size_x * header.size_y * header.words_per_column &&
+                 file_bytes == kHeaderBytes + header.word_count * sizeof(uint64_t);
+    if (!valid) {
+        munmap(base, file_bytes);
+        LOG(INFO) << "网格缓存不匹配，忽略: " << path;
+        return false;
+    }
+
+    uint64_t* bits = reinterpret_cast<uint64_t*>(static_cast<char*>(base) + kHeaderBytes);
+    std::shared_ptr<uint64_t> storage(bits,
+                                      [base, file_bytes](uint64_t*) { munmap(base, file_bytes); });
+    grid = OccupancyGrid(header.size_x, header.size_y, header.size_z, header.origin_x,
+                         header.origin_y, header.origin_z, header.cell_size_x, header.cell_size_y,
+                         header.cell_size_z, std::move(storage));
+    return true;
+}
+
+bool GridCache::save(uint64_t key, const OccupancyGrid& grid) const {
+    if (grid.empty()) {
+        return false;
+    }
+    if (mkdir(this->_cache_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        LOG(INFO) << "创建网格缓存目录失败: " << this->_cache_dir;
+        return false;
+    }
+
+    char header_buf[kHeaderBytes];
+    std::memset(header_buf, 0, sizeof(header_buf));
+    GridCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.header_bytes = kHeaderBytes;
+    header.key = key;
+    header.size_x = grid.size_x();
+    header.size_y = grid.size_y();
+    header.size_z = grid.size_z();
+    header.words_per_column = grid.words_per_column();
+    header.origin_x = grid.origin_x();
+    header.origin_y = grid.origin_y();
+    header.origin_z = grid.origin_z();
+    header.cell_size_x = grid.cell_size_x();
+    header.cell_size_y = grid.cell_size_y();
+    header.cell_size_z = grid.cell_size_z();
+    header.word_count = grid.word_count();
+    std::memcpy(header_buf, &header, sizeof(header));
+
+    std::string path = this->cache_path(key);
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    FILE* fp = fopen(tmp_path.c_str(), "wb");
+    if (fp == nullptr) {
+        LOG(INFO) << "写入网格缓存失败: " << tmp_path;
+        return false;
+    }
+    bool ok = fwrite(header_buf, 1, kHeaderBytes, fp) == kHeaderBytes &&
+              fwrite(grid.data(), sizeof(uint64_t), grid.word_count(), fp) == grid.word_count();
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        unlink(tmp_path.c_str());
+        LOG(INFO) << "写入网格缓存失败: " << path;
+        return false;
+    }
+    return true;
+}
+
+bool GridCache::load_data(uint64_t key, const std::string& suffix, void* data,
+                          size_t bytes) const {
+    std::string path = this->cache_path(key, suffix);
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == nullptr) {
+        return false;
+    }
+    DataCacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+              std::memcmp(header.magic, kDataMagic, sizeof(kDataMagic)) == 0 &&
+              header.version == kDataVersion && header.key == key && header.bytes == bytes &&
+              fread(data, 1, bytes, fp) == bytes;
+    fclose(fp);
+    if (!ok) {
+        LOG(INFO) << "缓存数据不匹配，忽略: " << path;
+    }
+    return ok;
+}
+
+bool GridCache::save_data(uint64_t key, const std::string& suffix, const void* data,
+                          size_t bytes) const {
+    if (mkdir(this->_cache_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        LOG(INFO) << "创建网格缓存目录失败: " << this->_cache_dir;
+        return false;
+    }
+    DataCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kDataMagic, sizeof(kDataMagic));
+    header.version = kDataVersion;
+    header.key = key;
+    header.bytes = bytes;
+
+    std::string path = this->cache_path(key, suffix);
+    std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    FILE* fp = fopen(tmp_path.c_str(), "wb");
+    if (fp == nullptr) {
+        LOG(INFO) << "写入缓存数据失败: " << tmp_path;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(data, 1, bytes, fp) == bytes;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        unlink(tmp_path.c_str());
+        LOG(INFO) << "写入缓存数据失败: " << path;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,179 @@
+#include "hierarchical_planner.h"
+#include <glog/logging.h>
+#include <algorithm>
+
+namespace mtuav::algorithm {
+
+HierarchicalPlanner::HierarchicalPlanner(const OccupancyPyramid& pyramid) : _pyramid(pyramid) {}
+
+void HierarchicalPlanner::set_corridor_radius(int radius) {
+    this->_corridor_radius = std::max(0, radius);
+}
+
+void HierarchicalPlanner::set_cost_layer(const AStar::CostLayer* cost_layer) {
+    this->_cost_layer = cost_layer;
+}
+
+void HierarchicalPlanner::set_any_angle(bool enable) {
+    this->_any_angle = enable;
+}
+
+void HierarchicalPlanner::set_landmarks(const LandmarkSet* landmarks) {
+    this->_landmarks = landmarks;
+}
+
+void HierarchicalPlanner::set_workspace(AStar::SearchWorkspace* workspace) {
+    this->_workspace = workspace;
+}
+
+bool HierarchicalPlanner::reached(const AStar::CoordinateList& path, AStar::Vec2i target) {
+    return !path.empty() && path.front().x == target.x && path.front().y == target.y;
+}
+
+AStar::CoordinateList HierarchicalPlanner::find_path(
+    AStar::Vec2i source, AStar::Vec2i target, int layer,
+    const AStar::CoordinateList& extra_collisions) {
+    AStar::CoordinateList boundary;  // 当前层走廊的边界，为空表示不限制
+    for (int level = this->_pyramid.level_num() - 1; level >= 1; level--) {
+        AStar::Vec2i level_source = {source.x >> level, source.y >> level};
+        AStar::Vec2i level_target = {target.x >> level, target.y >> level};
+        auto path = this->search(level, level_source, level_target, layer, boundary, {});
+        if (!reached(path, level_target) && !boundary.empty()) {
+            // 走廊内无解，退化为整层搜索
+            path = this->search(level, level_source, level_target, layer, {}, {});
+        }
+        if (reached(path, level_target)) {
+            boundary = this->make_corridor(level, path);
+        } else {
+            boundary.clear();
+        }
+    }
+
+    auto path = this->search(0, source, target, layer, boundary, extra_collisions);
+    if (!reached(path, target) && !boundary.empty()) {
+        LOG(INFO) << "走廊内未找到路径，退化为全图搜索";
+        path = this->search(0, source, target, layer, {}, extra_collisions);
+    }
+    if (this->_any_angle && reached(path, target)) {
+        // 走廊边界会挡住部分直线，去掉走廊后再合并一次拐点
+        AStar::Generator generator;
+        this->configure(generator, 0, layer, source, target, extra_collisions);
+        path = generator.smoothPath(path);
+    }
+    return path;
+}
+
+void HierarchicalPlanner::configure(AStar::Generator& generator, int level, int layer,
+                                    AStar::Vec2i source, AStar::Vec2i target,
+                                    const AStar::CoordinateList& extra_collisions) {
+    const OccupancyGrid& grid = this->_pyramid.level(level);
+    generator.setWorldSize({grid.size_x(), grid.size_y()});
+    generator.setWorkspace(this->_workspace);
+    // 对角距离是10/14代价下的精确下界，保证JPS与A*得到同样的最优路径
+    generator.setHeuristic(AStar::Heuristic::octagonal);
+    generator.setDiagonalMovement(true);
+    // 未设置代价层时（粗层）使用跳点搜索；最细层有代价层或任意角度搜索时退回A*/Theta*
+    generator.setJumpPointSearch(true);
+    // 静态障碍直接引用预先计算的碰撞层
+    generator.setCollisionLayer(this->_pyramid.collision_layer(level, layer));
+    if (level == 0) {
+        generator.setCostLayer(this->_cost_layer);
+        if (this->_landmarks != nullptr) {
+            generator.setLandmarks(this->_landmarks->table(layer));
+        }
+        if (this->_any_angle) {
+            // 任意角度路径的长度为欧氏距离，对角距离不再是下界
+            generator.setHeuristic(AStar::Heuristic::euclidean);
+            generator.setAnyAngle(true);
+        } else if (!extra_collisions.empty()) {
+            // 临时障碍可能把终点围住，单向搜索（包括JPS）要扩展起点所在的整个连通区域才能确认
+            // 不可达，双向搜索从终点一侧很快耗尽；可达的查询上它比单向搜索慢10~20%，
+            // 因此只在有临时障碍时开启，并优先于JPS
+            generator.setJumpPointSearch(false);
+            generator.setBidirectional(true);
+        }
+    }
+    if (level == 0 && this->_cost_layer != nullptr) {
+        // 起终点（如危险区域内的取货点、降落点）位于代价层的禁止区域时解除与其连通的整个区域，
+        // 否则路径无法从区域边缘进入；区域内的静态障碍保留，临时障碍在之后添加，仍然有效
+        const AStar::CollisionLayer* collision_layer = this->_pyramid.collision_layer(0, layer);
+        for (AStar::Vec2i endpoint : {source, target}) {
+            for (auto& coordinate : this->_cost_layer->blockedRegion(endpoint)) {
+                if (!collision_layer->isBlocked(coordinate)) {
+                    generator.removeCollision(coordinate);
+                }
+            }
+        }
+    }
+    for (auto& coordinate : extra_collisions) {
+        generator.addCollision(coordinate);
+    }
+    if (level > 0 || !extra_collisions.empty() || this->_cost_layer != nullptr) {
+        // 粗层的起终点可能与障碍同处一个cell，临时障碍和代价层也不能堵住起终点
+        generator.removeCollision(source);
+        generator.removeCollision(target);
+    }
+}
+
+AStar::CoordinateList HierarchicalPlanner::search(int level, AStar::Vec2i source,
+                                                  AStar::Vec2i target, int layer,
+                                                  const AStar::CoordinateList& boundary,
+                                                  const AStar::CoordinateList& extra_collisions) {
+    if (this->_pyramid.collision_layer(level, layer) == nullptr) {
+        LOG(INFO) << "飞行高度超出地图范围, layer: " << layer;
+        return {};
+    }
+    AStar::Generator generator;
+    this->configure(generator, level, layer, source, target, extra_collisions);
+    for (auto& coordinate : boundary) {
+        generator.addCollision(coordinate);
+    }
+    return generator.findPath(source, target);
+}
+
+AStar::CoordinateList HierarchicalPlanner::make_corridor(int level,
+                                                         const AStar::CoordinateList& path) {
+    const OccupancyGrid& fine = this->_pyramid.level(level - 1);
+    int grid_n_x = fine.size_x();
+    int grid_n_y = fine.size_y();
+    int r = this->_corridor_radius;
+    // 0：走廊外，1：走廊内，2：已加入边界
+    std::vector<uint8_t> mask((size_t)grid_n_x * grid_n_y, 0);
+    AStar::CoordinateList cells;
+    for (auto& coordinate : path) {
+        // 粗层cell对应细层的2x2个cell，再向外膨胀r个cell
+        int x_begin = std::max(0, coordinate.x * 2 - r);
+        int x_end = std::min(grid_n_x - 1, coordinate.x * 2 + 1 + r);
+        int y_begin = std::max(0, coordinate.y * 2 - r);
+        int y_end = std::min(grid_n_y - 1, coordinate.y * 2 + 1 + r);
+        for (int x = x_begin; x <= x_end; x++) {
+            for (int y = y_begin; y <= y_end; y++) {
+                uint8_t& m = mask[(size_t)x * grid_n_y + y];
+                if (!m) {
+                    m = 1;
+                    cells.push_back({x, y});
+                }
+            }
+        }
+    }
+    // 走廊外紧邻走廊的一圈cell作为边界，只遍历走廊内的cell
+    AStar::CoordinateList boundary;
+    for (auto& c : cells) {
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                int nx = c.x + dx, ny = c.y + dy;
+                if (nx < 0 || nx >= grid_n_x || ny < 0 || ny >= grid_n_y) {
+                    continue;
+                }
+                uint8_t& m = mask[(size_t)nx * grid_n_y + ny];
+                if (!m) {
+                    m = 2;
+                    boundary.push_back({nx, ny});
+                }
+            }
+        }
+    }
+    return boundary;
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,168 @@
+#include "landmark_set.h"
+#include <glog/logging.h>
+#include <chrono>
+#include <string>
+#include "distance_field.h"
+
+namespace mtuav::algorithm {
+
+LandmarkSet::~LandmarkSet() {
+    this->_stop = true;
+    this->wait();
+}
+
+void LandmarkSet::build_async(const OccupancyPyramid& pyramid, const std::vector<int>& layers,
+                              int landmark_num, const GridCache* cache, uint64_t key) {
+    this->_stop = true;
+    this->wait();
+    this->_stop = false;
+    if (pyramid.empty() || landmark_num <= 0) {
+        return;
+    }
+    int size_z = pyramid.level(0).size_z();
+    this->_tables.assign(size_z, AStar::LandmarkTable());
+    this->_landmarks.assign(size_z, {});
+    this->_ready.reset(new std::atomic<bool>[size_z]);
+    for (int z = 0; z < size_z; z++) {
+        this->_ready[z] = false;
+    }
+    this->_cache.reset(cache != nullptr ? new GridCache(*cache) : nullptr);
+    this->_key = key;
+
+    this->_worker = std::thread([this, &pyramid, layers, landmark_num]() {
+        for (int z : layers) {
+            if (this->_stop) {
+                break;
+            }
+            if (z < 0 || z >= (int)this->_tables.size() || this->_ready[z]) {
+                continue;
+            }
+            auto begin = std::chrono::steady_clock::now();
+            bool cached = this->load(pyramid, z, landmark_num);
+            if (!cached) {
+                this->build_layer(pyramid, z, landmark_num);
+                if (this->_stop) {
+                    break;
+                }
+                this->save(z);
+            }
+            this->_ready[z].store(true, std::memory_order_release);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - begin);
+            std::string cells;
+            for (auto& landmark : this->_landmarks[z]) {
+                if (landmark.x >= 0) {
+                    cells += " (" + std::to_string(landmark.x) + ", " +
+                             std::to_string(landmark.y) + ")";
+                }
+            }
+            LOG(INFO) << "landmark距离表, 高度层: " << z << ", landmark数: " << landmark_num
+                      << (cached ? ", 从缓存加载" : ", 计算完成") << ", 耗时: " << elapsed.count()
+                      << " ms, landmark:" << cells;
+        }
+    });
+}
+
+void LandmarkSet::wait() {
+    if (this->_worker.joinable()) {
+        this->_worker.join();
+    }
+}
+
+const AStar::LandmarkTable* LandmarkSet::table(int z) const {
+    if (z < 0 || z >= (int)this->_tables.size() ||
+        !this->_ready[z].load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return &this->_tables[z];
+}
+
+void LandmarkSet::build_layer(const OccupancyPyramid& pyramid, int z, int landmark_num) {
+    const OccupancyGrid& grid = pyramid.level(0);
+    int size_x = grid.size_x();
+    int size_y = grid.size_y();
+    AStar::LandmarkTable table({size_x, size_y}, landmark_num);
+    std::vector<AStar::Vec2i> landmarks(landmark_num, AStar::Vec2i{-1, -1});
+    DistanceField field(grid, pyramid.collision_layer(0, z));
+
+    // min_cost[i]为第i个cell到已选landmark的最短距离，下一个landmark取其最大者
+    std::vector<uint32_t> min_cost((size_t)size_x * size_y, DistanceField::UNREACHABLE);
+    auto farthest = [&](const std::vector<uint32_t>& costs) {
+        AStar::Vec2i best = {-1, -1};
+        uint32_t best_cost = 0;
+        for (int x = 0; x < size_x; x++) {
+            for (int y = 0; y < size_y; y++) {
+                uint32_t c = costs[(size_t)x * size_y + y];
+                if (c != DistanceField::UNREACHABLE && (best.x < 0 || c > best_cost)) {
+                    best = {x, y};
+                    best_cost = c;
+                }
+            }
+        }
+        return best;
+    };
+
+    // 从网格中心（被占据时也可作为源点）扩展一次，取最远的可达cell作为第一个landmark
+    field.compute({size_x / 2, size_y / 2});
+    for (int x = 0; x < size_x; x++) {
+        for (int y = 0; y < size_y; y++) {
+            min_cost[(size_t)x * size_y + y] = field.cost({x, y});
+        }
+    }
+    for (int i = 0; i < landmark_num && !this->_stop; i++) {
+        AStar::Vec2i landmark = farthest(min_cost);
+        if (landmark.x < 0) {
+            break;  // 整层不可通行
+        }
+        landmarks[i] = landmark;
+        field.compute(landmark);
+        for (int x = 0; x < size_x; x++) {
+            for (int y = 0; y < size_y; y++) {
+                uint32_t c = field.cost({x, y});
+                table.setDistance(i, {x, y}, c);
+                uint32_t& m = min_cost[(size_t)x * size_y + y];
+                // 第一次时min_cost存放的是到网格中心的距离，需直接覆盖
+                m = (i == 0 || c < m) ? c : m;
+            }
+        }
+    }
+    this->_tables[z] = std::move(table);
+    this->_landmarks[z] = std::move(landmarks);
+}
+
+bool LandmarkSet::load(const OccupancyPyramid& pyramid, int z, int landmark_num) {
+    if (this->_cache == nullptr) {
+        return false;
+    }
+    // 数据长度由网格尺寸与landmark数决定，任一不同时load_data返回false
+    const OccupancyGrid& grid = pyramid.level(0);
+    std::string suffix = "alt" + std::to_string(z);
+    std::vector<AStar::Vec2i> landmarks(landmark_num);
+    AStar::LandmarkTable table({grid.size_x(), grid.size_y()}, landmark_num);
+    if (!this->_cache->load_data(this->_key, suffix + "_landmarks", landmarks.data(),
+                                 landmarks.size() * sizeof(AStar::Vec2i)) ||
+        !this->_cache->load_data(this->_key, suffix, table.data(),
+                                 table.dataSize() * sizeof(AStar::uint))) {
+        return false;
+    }
+    this->_tables[z] = std::move(table);
+    this->_landmarks[z] = std::move(landmarks);
+    return true;
+}
+
+void LandmarkSet::save(int z) const {
+    if (this->_cache == nullptr) {
+        return;
+    }
+    // 先写距离表再写landmark位置：load要求两者都存在，中途失败时不会读到不完整的一层
+    std::string suffix = "alt" + std::to_string(z);
+    const AStar::LandmarkTable& table = this->_tables[z];
+    const std::vector<AStar::Vec2i>& landmarks = this->_landmarks[z];
+    if (this->_cache->save_data(this->_key, suffix, table.data(),
+                                table.dataSize() * sizeof(AStar::uint))) {
+        this->_cache->save_data(this->_key, suffix + "_landmarks", landmarks.data(),
+                                landmarks.size() * sizeof(AStar::Vec2i));
+    }
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,96 @@
+#include "occupancy_grid.h"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace mtuav::algorithm {
+
+namespace {
+const int kCacheLineBytes = 64;
+const int kWordsPerCacheLine = kCacheLineBytes / sizeof(uint64_t);
+
+// 与AStar::Generator中direction的顺序一致
+const Grid3 kNeighborOffsets[8] = {
+    {0, 1, 0}, {1, 0, 0}, {0, -1, 0}, {-1, 0, 0}, {-1, -1, 0}, {1, 1, 0}, {-1, 1, 0}, {1, -1, 0},
+};
+}  // namespace
+
+OccupancyGrid::OccupancyGrid(int size_x, int size_y, int size_z, float origin_x, float origin_y,
+                             float origin_z, float cell_size_x, float cell_size_y,
+                             float cell_size_z)
+    : _size_x(size_x),
+      _size_y(size_y),
+      _size_z(size_z),
+      _origin_x(origin_x),
+      _origin_y(origin_y),
+      _origin_z(origin_z),
+      _cell_size_x(cell_size_x),
+      _cell_size_y(cell_size_y),
+      _cell_size_z(cell_size_z) {
+    _words_per_column = column_words(size_z);
+    size_t bytes = this->memory_bytes();
+    bytes = (bytes + kCacheLineBytes - 1) / kCacheLineBytes * kCacheLineBytes;
+    if (bytes == 0) {
+        return;
+    }
+    void* mem = std::aligned_alloc(kCacheLineBytes, bytes);
+    if (mem == nullptr) {
+        throw std::bad_alloc();
+    }
+    std::memset(mem, 0, bytes);
+    _bits = static_cast<uint64_t*>(mem);
+    _storage = std::shared_ptr<uint64_t>(_bits, [](uint64_t* p) { std::free(p); });
+}
+
+OccupancyGrid::OccupancyGrid(int size_x, int size_y, int size_z, float origin_x, float origin_y,
+                             float origin_z, float cell_size_x, float cell_size_y,
+                             float cell_size_z, std::shared_ptr<uint64_t> storage)
+    : _size_x(size_x),
+      _size_y(size_y),
+      _size_z(size_z),
+      _words_per_column(column_words(size_z)),
+      _origin_x(origin_x),
+      _origin_y(origin_y),
+      _origin_z(origin_z),
+      _cell_size_x(cell_size_x),
+      _cell_size_y(cell_size_y),
+      _cell_size_z(cell_size_z),
+      _storage(std::move(storage)) {
+    _bits = _storage.get();
+}
+
+int OccupancyGrid::column_words(int size_z) {
+    // z列长度取2的幂，不足一个cache line的列不会跨行；超过一个cache line则按整行对齐
+    int words = (size_z + 63) / 64;
+    int column = 1;
+    while (column < words && column < kWordsPerCacheLine) {
+        column <<= 1;
+    }
+    if (column < words) {
+        column = (words + kWordsPerCacheLine - 1) / kWordsPerCacheLine * kWordsPerCacheLine;
+    }
+    return column;
+}
+
+uint8_t OccupancyGrid::neighbors8(int x, int y, int z) const {
+    uint8_t mask = 0;
+    for (int i = 0; i < 8; i++) {
+        if (this->occupied(x + kNeighborOffsets[i].x, y + kNeighborOffsets[i].y, z)) {
+            mask |= (1 << i);
+        }
+    }
+    return mask;
+}
+
+const Grid3* OccupancyGrid::neighbor_offsets() { return kNeighborOffsets; }
+
+int64_t OccupancyGrid::count_occupied() const {
+    int64_t count = 0;
+    size_t n = this->word_count();
+    for (size_t i = 0; i < n; i++) {
+        count += __builtin_popcountll(_bits[i]);
+    }
+    return count;
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,36 @@
+#include "occupancy_pyramid.h"
+
+namespace mtuav::algorithm {
+
+void OccupancyPyramid::build(const OccupancyGrid& base, int level_num) {
+    this->_base = &base;
+    this->_levels.clear();
+    for (int l = 1; l < level_num; l++) {
+        const OccupancyGrid& fine = this->level(l - 1);
+        if (fine.size_x() <= 1 && fine.size_y() <= 1) {
+            break;  // 已无法继续合并
+        }
+        OccupancyGrid coarse((fine.size_x() + 1) / 2, (fine.size_y() + 1) / 2, fine.size_z(),
+                             fine.origin_x(), fine.origin_y(), fine.origin_z(),
+                             fine.cell_size_x() * 2, fine.cell_size_y() * 2, fine.cell_size_z());
+        int words = coarse.words_per_column();
+        for (int x = 0; x < fine.size_x(); x++) {
+            for (int y = 0; y < fine.size_y(); y++) {
+                // z列按位或合并
+                const uint64_t* src = fine.column(x, y);
+                uint64_t* dst = coarse.column(x / 2, y / 2);
+                for (int w = 0; w < words; w++) {
+                    dst[w] |= src[w];
+                }
+            }
+        }
+        this->_levels.push_back(std::move(coarse));
+    }
+
+    this->_collision_layers.assign(this->level_num(), CollisionLayerSet());
+    for (int l = 0; l < this->level_num(); l++) {
+        this->_collision_layers[l].build(this->level(l));
+    }
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,61 @@
+#include "path_cache.h"
+#include <algorithm>
+
+namespace mtuav::algorithm {
+
+bool PathCache::Key::operator==(const Key& other) const {
+    return start.x == other.start.x && start.y == other.start.y && start.z == other.start.z &&
+           goal.x == other.goal.x && goal.y == other.goal.y && goal.z == other.goal.z;
+}
+
+size_t PathCache::KeyHash::operator()(const Key& key) const {
+    // 各坐标依次混入64位FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (int v : {key.start.x, key.start.y, key.start.z, key.goal.x, key.goal.y, key.goal.z}) {
+        hash = (hash ^ (uint32_t)v) * 1099511628211ull;
+    }
+    return hash;
+}
+
+PathCache::PathCache(size_t capacity) : _capacity(std::max<size_t>(1, capacity)) {}
+
+bool PathCache::lookup(const Grid3& start, const Grid3& goal, std::vector<Grid3>& path) {
+    auto it = this->_index.find({start, goal});
+    if (it == this->_index.end()) {
+        this->_misses++;
+        return false;
+    }
+    this->_entries.splice(this->_entries.begin(), this->_entries, it->second);
+    path = it->second->path;
+    this->_hits++;
+    return true;
+}
+
+void PathCache::insert(const Grid3& start, const Grid3& goal, std::vector<Grid3> path) {
+    Key key = {start, goal};
+    auto it = this->_index.find(key);
+    if (it != this->_index.end()) {
+        it->second->path = std::move(path);
+        this->_entries.splice(this->_entries.begin(), this->_entries, it->second);
+        return;
+    }
+    if (this->_index.size() >= this->_capacity) {
+        this->_index.erase(this->_entries.back().key);
+        this->_entries.pop_back();
+    }
+    this->_entries.push_front({key, std::move(path)});
+    this->_index[key] = this->_entries.begin();
+}
+
+void PathCache::invalidate() {
+    // 直接清空，失效的项不会继续占用LRU的容量
+    this->_index.clear();
+    this->_entries.clear();
+}
+
+double PathCache::hit_rate() const {
+    uint64_t total = this->_hits + this->_misses;
+    return total == 0 ? 0 : (double)this->_hits / total;
+}
+
+}  // namespace mtuav::algorithm
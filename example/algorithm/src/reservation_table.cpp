@@ -0,0 +1,117 @@
+#include "reservation_table.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mtuav::algorithm {
+
+ReservationTable::ReservationTable(int64_t bucket_ms)
+    : _bucket_ms(std::max<int64_t>(1, bucket_ms)) {}
+
+void ReservationTable::reset(const OccupancyGrid& grid) {
+    this->_grid = &grid;
+    this->_cells.clear();
+}
+
+uint32_t ReservationTable::owner_id(const std::string& drone_id) {
+    uint32_t id = (uint32_t)std::hash<std::string>()(drone_id);
+    return id == kShared ? 1 : id;
+}
+
+uint64_t ReservationTable::key(int x, int y, int z, int64_t bucket) const {
+    uint64_t cell = ((uint64_t)x * this->_grid->size_y() + y) * this->_grid->size_z() + z;
+    uint64_t cell_num = (uint64_t)this->_grid->size_x() * this->_grid->size_y() *
+                        this->_grid->size_z();
+    return (uint64_t)bucket * cell_num + cell;
+}
+
+void ReservationTable::sample(const std::vector<Segment>& segs, int64_t takeoff_ms,
+                              const std::function<void(const Grid3&, int64_t)>& visit) const {
+    double step = 0.5 * std::min(this->_grid->cell_size_x(), this->_grid->cell_size_z());
+    for (size_t i = 0; i < segs.size(); i++) {
+        const Segment& b = segs[i];
+        if (i == 0) {
+            visit(this->_grid->world_to_cell(b.position), takeoff_ms + (int64_t)b.time_ms);
+            continue;
+        }
+        const Segment& a = segs[i - 1];
+        double dx = b.position.x - a.position.x;
+        double dy = b.position.y - a.position.y;
+        double dz = b.position.z - a.position.z;
+        int64_t dt = (int64_t)b.time_ms - (int64_t)a.time_ms;
+        int n = std::max((int)std::ceil(std::sqrt(dx * dx + dy * dy + dz * dz) / step),
+                         (int)(2 * std::max<int64_t>(dt, 0) / this->_bucket_ms));
+        n = std::max(n, 1);
+        for (int k = 1; k <= n; k++) {
+            double r = (double)k / n;
+            Vec3 p = {a.position.x + r * dx, a.position.y + r * dy, a.position.z + r * dz};
+            visit(this->_grid->world_to_cell(p),
+                  takeoff_ms + (int64_t)a.time_ms + (int64_t)(r * dt));
+        }
+    }
+}
+
+void ReservationTable::reserve(uint32_t owner, const std::vector<Segment>& segs,
+                               int64_t takeoff_ms, int64_t from_ms) {
+    if (this->_grid == nullptr || segs.empty()) {
+        return;
+    }
+    Grid3 last_cell = {-1, -1, -1};
+    int64_t last_bucket = -1;
+    this->sample(segs, takeoff_ms, [&](const Grid3& cell, int64_t time_ms) {
+        if (time_ms < from_ms) {
+            return;
+        }
+        int64_t bucket = time_ms / this->_bucket_ms;
+        // 连续落在同一cell、同一时间桶的采样点只预约一次
+        if (bucket == last_bucket && cell.x == last_cell.x && cell.y == last_cell.y &&
+            cell.z == last_cell.z) {
+            return;
+        }
+        last_cell = cell;
+        last_bucket = bucket;
+        for (int x = cell.x - 1; x <= cell.x + 1; x++) {
+            for (int y = cell.y - 1; y <= cell.y + 1; y++) {
+                for (int z = cell.z - 1; z <= cell.z + 1; z++) {
+                    if (!this->_grid->in_bounds(x, y, z)) {
+                        continue;
+                    }
+                    auto [it, inserted] = this->_cells.emplace(this->key(x, y, z, bucket), owner);
+                    if (!inserted && it->second != owner) {
+                        it->second = kShared;
+                    }
+                }
+            }
+        }
+    });
+}
+
+bool ReservationTable::conflicts(const Grid3& cell, int64_t time_ms, uint32_t owner) const {
+    if (this->_grid == nullptr || this->_cells.empty() ||
+        !this->_grid->in_bounds(cell.x, cell.y, cell.z)) {
+        return false;
+    }
+    int64_t bucket = time_ms / this->_bucket_ms;
+    for (int64_t b = bucket - 1; b <= bucket + 1; b++) {
+        auto it = this->_cells.find(this->key(cell.x, cell.y, cell.z, b));
+        if (it != this->_cells.end() && it->second != owner) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int ReservationTable::count_conflicts(const std::vector<Segment>& segs, int64_t takeoff_ms,
+                                      uint32_t owner) const {
+    int count = 0;
+    if (this->_grid == nullptr || this->_cells.empty()) {
+        return 0;
+    }
+    this->sample(segs, takeoff_ms, [&](const Grid3& cell, int64_t time_ms) {
+        if (this->conflicts(cell, time_ms, owner)) {
+            count++;
+        }
+    });
+    return count;
+}
+
+}  // namespace mtuav::algorithm
@@ -0,0 +1,180 @@
+#include "segment_collision_checker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include "AStarEngine.h"
+
+namespace mtuav::algorithm {
+
+SegmentCollisionChecker::SegmentCollisionChecker(const OccupancyGrid& grid) : _grid(grid) {}
+
+void SegmentCollisionChecker::set_esdf_layers(const EsdfLayerCache* esdf_layers,
+                                              float safe_distance) {
+    // 安全距离为0时最小步长无法保证不跳过薄障碍物，此时不使用球追踪
+    this->_esdf_layers = safe_distance > 0 ? esdf_layers : nullptr;
+    this->_safe_distance = safe_distance;
+}
+
+void SegmentCollisionChecker::check(const std::vector<LineSegment>& segments,
+                                    std::vector<SegmentHit>& results) const {
+    results.resize(segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        results[i] = this->check(segments[i]);
+    }
+}
+
+SegmentHit SegmentCollisionChecker::check(const LineSegment& segment) const {
+    if (this->_esdf_layers != nullptr) {
+        const EsdfLayer* layer = this->_esdf_layers->layer(segment.from.z);
+        if (layer != nullptr && std::fabs(segment.to.z - layer->altitude()) <= 1.0) {
+            return this->sphere_trace(segment, *layer);
+        }
+    }
+    return this->traverse_grid(segment);
+}
+
+bool SegmentCollisionChecker::is_free(const Vec3& from, const Vec3& to) const {
+    return !this->check({from, to}).blocked;
+}
+
+void SegmentCollisionChecker::set_cost_layer(const AStar::CostLayer* cost_layer) {
+    this->_cost_layer = cost_layer;
+}
+
+bool SegmentCollisionChecker::line_of_sight(int x0, int y0, int x1, int y1, int layer,
+                                            uint32_t* extra_cost, int* cell_count) const {
+    uint32_t extra = 0;
+    int cells = 0;
+    auto blocked = [this, layer](AStar::Vec2i c) {
+        return this->_grid.occupied(c.x, c.y, layer) ||
+               (this->_cost_layer != nullptr &&
+                this->_cost_layer->getCost(c) == AStar::CostLayer::BLOCKED);
+    };
+    bool visible = !this->_grid.occupied(x0, y0, layer) &&
+                   AStar::supercoverLine({x0, y0}, {x1, y1}, blocked, [&](AStar::Vec2i c) {
+                       if (blocked(c)) {
+                           return false;
+                       }
+                       extra += this->_cost_layer != nullptr ? this->_cost_layer->getCost(c) : 0;
+                       cells++;
+                       return true;
+                   });
+    if (extra_cost != nullptr) {
+        *extra_cost = extra;
+    }
+    if (cell_count != nullptr) {
+        *cell_count = cells;
+    }
+    return visible;
+}
+
+SegmentHit SegmentCollisionChecker::traverse_grid(const LineSegment& segment) const {
+    const double kInf = std::numeric_limits<double>::infinity();
+    const double kEps = 1e-9;
+    SegmentHit hit;
+    // 换算到以cell为单位的连续坐标
+    double g0[3] = {(segment.from.x - _grid.origin_x()) / _grid.cell_size_x(),
+                    (segment.from.y - _grid.origin_y()) / _grid.cell_size_y(),
+                    (segment.from.z - _grid.origin_z()) / _grid.cell_size_z()};
+    double g1[3] = {(segment.to.x - _grid.origin_x()) / _grid.cell_size_x(),
+                    (segment.to.y - _grid.origin_y()) / _grid.cell_size_y(),
+                    (segment.to.z - _grid.origin_z()) / _grid.cell_size_z()};
+    int cell[3], end_cell[3], step[3];
+    double t_max[3], t_delta[3];
+    for (int a = 0; a < 3; a++) {
+        cell[a] = (int)std::floor(g0[a]);
+        end_cell[a] = (int)std::floor(g1[a]);
+        double d = g1[a] - g0[a];
+        if (d > 0) {
+            step[a] = 1;
+            t_delta[a] = 1.0 / d;
+            t_max[a] = (cell[a] + 1 - g0[a]) / d;
+        } else if (d < 0) {
+            step[a] = -1;
+            t_delta[a] = -1.0 / d;
+            t_max[a] = (cell[a] - g0[a]) / d;
+        } else {
+            step[a] = 0;
+            t_delta[a] = kInf;
+            t_max[a] = kInf;
+        }
+    }
+
+    auto blocked_at = [&](const int* c, double t) {
+        if (!_grid.occupied(c[0], c[1], c[2])) {
+            return false;
+        }
+        hit.blocked = true;
+        hit.hit_cell = {c[0], c[1], c[2]};
+        hit.hit_point = {segment.from.x + (segment.to.x - segment.from.x) * t,
+                         segment.from.y + (segment.to.y - segment.from.y) * t,
+                         segment.from.z + (segment.to.z - segment.from.z) * t};
+        return true;
+    };
+
+    if (blocked_at(cell, 0)) {
+        return hit;
+    }
+    while (cell[0] != end_cell[0] || cell[1] != end_cell[1] || cell[2] != end_cell[2]) {
+        double t = std::min(t_max[0], std::min(t_max[1], t_max[2]));
+        if (t > 1.0) {
+            break;  // 浮点误差，已到达终点
+        }
+        // 同时到达多个边界（穿过棱或角）时，先检查只跨过其中一个边界的相邻cell
+        int tied[3], tied_num = 0;
+        for (int a = 0; a < 3; a++) {
+            if (t_max[a] - t <= kEps) {
+                tied[tied_num++] = a;
+            }
+        }
+        if (tied_num > 1) {
+            for (int k = 0; k < tied_num; k++) {
+                int side[3] = {cell[0], cell[1], cell[2]};
+                side[tied[k]] += step[tied[k]];
+                if (blocked_at(side, t)) {
+                    return hit;
+                }
+            }
+        }
+        for (int k = 0; k < tied_num; k++) {
+            cell[tied[k]] += step[tied[k]];
+            t_max[tied[k]] += t_delta[tied[k]];
+        }
+        if (blocked_at(cell, t)) {
+            return hit;
+        }
+    }
+    return hit;
+}
+
+SegmentHit SegmentCollisionChecker::sphere_trace(const LineSegment& segment,
+                                                 const EsdfLayer& layer) const {
+    SegmentHit hit;
+    double dx = segment.to.x - segment.from.x;
+    double dy = segment.to.y - segment.from.y;
+    double length = std::sqrt(dx * dx + dy * dy);
+    // 未碰撞时distance >= _safe_distance，最小步长不超过安全距离即不超过当前的离障距离，
+    // 每一步都落在以当前点为球心的无障碍球内，不会跳过障碍物
+    double min_step = std::min(0.1 * layer.resolution(), (double)this->_safe_distance);
+    double s = 0;
+    while (true) {
+        double ratio = length > 0 ? s / length : 0;
+        Vec3 p = {segment.from.x + dx * ratio, segment.from.y + dy * ratio,
+                  segment.from.z + (segment.to.z - segment.from.z) * ratio};
+        float distance = layer.interpolate(p.x, p.y);
+        if (distance < this->_safe_distance || distance <= 0) {
+            hit.blocked = true;
+            hit.hit_point = p;
+            hit.hit_cell = _grid.world_to_cell(p);
+            return hit;
+        }
+        if (s >= length) {
+            break;
+        }
+        s = std::min(length, s + std::max(distance - this->_safe_distance, (float)min_step));
+    }
+    return hit;
+}
+
+}  // namespace mtuav::algorithm
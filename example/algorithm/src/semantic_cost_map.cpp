@@ -0,0 +1,57 @@
+#include "semantic_cost_map.h"
+#include <glog/logging.h>
+
+namespace mtuav::algorithm {
+
+SemanticCostMap::SemanticCostMap() {
+    this->_semantic_costs[SEM_GROUND] = 2;
+    this->_semantic_costs[SEM_VEGETATION] = 2;
+    this->_semantic_costs[SEM_ROAD] = 0;  // 优先沿道路上空飞行
+    this->_semantic_costs[SEM_BUILDING] = 4;
+    this->_semantic_costs[SEM_DANGEROUS] = AStar::CostLayer::BLOCKED;
+}
+
+void SemanticCostMap::set_semantic_cost(BlockSemantic semantic, uint8_t cost) {
+    this->_semantic_costs[semantic] = cost;
+}
+
+uint8_t SemanticCostMap::semantic_cost(uint8_t semantic) const {
+    auto it = this->_semantic_costs.find(semantic);
+    return it == this->_semantic_costs.end() ? this->_default_cost : it->second;
+}
+
+void SemanticCostMap::build(std::shared_ptr<Map> map, const OccupancyGrid& grid,
+                            const GridCache* cache, uint64_t key) {
+    this->_layer = AStar::CostLayer({grid.size_x(), grid.size_y()});
+    // 缓存的是各列的语义而不是代价，修改set_semantic_cost后缓存仍然有效
+    std::vector<uint8_t> semantics((size_t)grid.size_x() * grid.size_y());
+    if (cache == nullptr || !cache->load_data(key, "semantic", semantics.data(), semantics.size())) {
+        // 在网格最高一层查询，得到每列最上方实体的语义
+        double query_z = grid.cell_center_z(grid.size_z() - 1);
+        for (int x = 0; x < grid.size_x(); x++) {
+            for (int y = 0; y < grid.size_y(); y++) {
+                const Voxel* voxel =
+                    map->Query(grid.cell_center_x(x), grid.cell_center_y(y), query_z);
+                semantics[(size_t)x * grid.size_y() + y] =
+                    (voxel != nullptr) ? voxel->semantic : static_cast<uint8_t>(SEM_GROUND);
+            }
+        }
+        if (cache != nullptr) {
+            cache->save_data(key, "semantic", semantics.data(), semantics.size());
+        }
+    }
+    std::map<uint8_t, int> semantic_count;
+    for (int x = 0; x < grid.size_x(); x++) {
+        for (int y = 0; y < grid.size_y(); y++) {
+            uint8_t semantic = semantics[(size_t)x * grid.size_y() + y];
+            semantic_count[semantic]++;
+            this->_layer.setCost({x, y}, this->semantic_cost(semantic));
+        }
+    }
+    for (auto& [semantic, count] : semantic_count) {
+        LOG(INFO) << "语义: " << int(semantic) << ", 列数: " << count
+                  << ", 附加代价: " << int(this->semantic_cost(semantic));
+    }
+}
+
+}  // namespace mtuav::algorithm
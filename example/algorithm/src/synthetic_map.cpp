@@ -0,0 +1,177 @@
+#include "synthetic_map.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace mtuav::algorithm {
+
+namespace {
+// 不使用std::uniform_real_distribution，其结果依赖标准库实现，不同机器上生成的地图会不同
+float uniform(std::mt19937& rng, float lo, float hi) {
+    return lo + (hi - lo) * static_cast<float>(rng() / 4294967296.0);
+}
+}  // namespace
+
+SyntheticMap::SyntheticMap(const SyntheticMapConfig& config) : _config(config) {
+    this->generate();
+    LOG(INFO) << "合成地图: " << this->_config.size_x << "x" << this->_config.size_y
+              << "m, 街区数: " << this->_block_num_x * this->_block_num_y
+              << ", 房屋数: " << this->_building_count
+              << ", 危险区域数: " << this->_dangerous_count;
+}
+
+void SyntheticMap::generate() {
+    const SyntheticMapConfig& c = this->_config;
+    float block = c.block_size;
+    float half_road = 0.5f * c.road_width;
+    this->_block_num_x = std::max(1, (int)std::ceil(c.size_x / block));
+    this->_block_num_y = std::max(1, (int)std::ceil(c.size_y / block));
+    int block_num = this->_block_num_x * this->_block_num_y;
+    this->_boxes.clear();
+    this->_block_begin.assign(block_num + 1, 0);
+    this->_block_semantic.assign(block_num, SEM_GROUND);
+    this->_building_count = 0;
+    this->_dangerous_count = 0;
+
+    std::mt19937 rng(c.seed);
+    for (int bx = 0; bx < this->_block_num_x; bx++) {
+        for (int by = 0; by < this->_block_num_y; by++) {
+            int index = this->block_index(bx, by);
+            this->_block_begin[index] = this->_boxes.size();
+            // 街区内部（去掉四周的半条道路）
+            float x0 = bx * block + half_road;
+            float x1 = std::min((bx + 1) * block - half_road, c.size_x);
+            float y0 = by * block + half_road;
+            float y1 = std::min((by + 1) * block - half_road, c.size_y);
+            if (x1 <= x0 || y1 <= y0) {
+                continue;
+            }
+            float r = uniform(rng, 0, 1);
+            if (r < c.dangerous_ratio) {
+                this->_boxes.push_back({x0, x1, y0, y1, c.dangerous_height, SEM_DANGEROUS});
+                this->_dangerous_count++;
+                continue;
+            }
+            if (r < c.dangerous_ratio + c.park_ratio) {
+                this->_block_semantic[index] = SEM_VEGETATION;
+                continue;
+            }
+            int lots = std::max(1, c.lots_per_side);
+            float lot_x = (x1 - x0) / lots;
+            float lot_y = (y1 - y0) / lots;
+            for (int i = 0; i < lots; i++) {
+                for (int j = 0; j < lots; j++) {
+                    if (uniform(rng, 0, 1) >= c.building_density) {
+                        continue;
+                    }
+                    // 每侧随机退让5%~25%的地块宽度
+                    float lx = x0 + i * lot_x;
+                    float ly = y0 + j * lot_y;
+                    Box box;
+                    box.min_x = lx + uniform(rng, 0.05f, 0.25f) * lot_x;
+                    box.max_x = lx + lot_x - uniform(rng, 0.05f, 0.25f) * lot_x;
+                    box.min_y = ly + uniform(rng, 0.05f, 0.25f) * lot_y;
+                    box.max_y = ly + lot_y - uniform(rng, 0.05f, 0.25f) * lot_y;
+                    box.max_z = uniform(rng, c.min_building_height, c.max_building_height);
+                    box.semantic = SEM_BUILDING;
+                    this->_boxes.push_back(box);
+                    this->_building_count++;
+                }
+            }
+        }
+    }
+    this->_block_begin[block_num] = this->_boxes.size();
+}
+
+void SyntheticMap::Range(float* min_x, float* max_x, float* min_y, float* max_y, float* min_z,
+                         float* max_z) {
+    *min_x = 0;
+    *max_x = this->_config.size_x;
+    *min_y = 0;
+    *max_y = this->_config.size_y;
+    *min_z = this->_config.min_z;
+    *max_z = this->_config.max_z;
+}
+
+float SyntheticMap::box_distance(const Box& box, float x, float y, float z) {
+    float dx = std::max(box.min_x - x, x - box.max_x);
+    float dy = std::max(box.min_y - y, y - box.max_y);
+    float dz = z - box.max_z;  // 长方体向下延伸到地面以下，只有顶面
+    float ox = std::max(dx, 0.0f), oy = std::max(dy, 0.0f), oz = std::max(dz, 0.0f);
+    float outside = std::sqrt(ox * ox + oy * oy + oz * oz);
+    float inside = std::min(std::max(dx, std::max(dy, dz)), 0.0f);
+    return outside + inside;
+}
+
+uint8_t SyntheticMap::ground_semantic(float x, float y, int block_x, int block_y) const {
+    float block = this->_config.block_size;
+    float half_road = 0.5f * this->_config.road_width;
+    float lx = x - block_x * block;
+    float ly = y - block_y * block;
+    if (lx < half_road || lx > block - half_road || ly < half_road || ly > block - half_road) {
+        return SEM_ROAD;
+    }
+    return this->_block_semantic[this->block_index(block_x, block_y)];
+}
+
+const Voxel* SyntheticMap::Query(float x, float y, float z) {
+    const SyntheticMapConfig& c = this->_config;
+    if (x < 0 || x > c.size_x || y < 0 || y > c.size_y || z < c.min_z || z > c.max_z) {
+        return nullptr;
+    }
+    thread_local Voxel voxel;
+    float block = c.block_size;
+    int bx = std::clamp((int)std::floor(x / block), 0, this->_block_num_x - 1);
+    int by = std::clamp((int)std::floor(y / block), 0, this->_block_num_y - 1);
+
+    // 地面是z<=0的半空间；再由近及远逐圈遍历街区，
+    // 第k圈街区中的实体与查询点的水平距离不小于(k-1)*block，已找到更近的实体时即可停止
+    float best = z;
+    int best_box = -1;
+    int max_ring = std::max(this->_block_num_x, this->_block_num_y);
+    for (int k = 0; k <= max_ring; k++) {
+        if (k >= 1 && best <= (k - 1) * block) {
+            break;
+        }
+        for (int i = bx - k; i <= bx + k; i++) {
+            if (i < 0 || i >= this->_block_num_x) {
+                continue;
+            }
+            // 只遍历第k圈上的街区
+            int step = (i == bx - k || i == bx + k) ? 1 : std::max(1, 2 * k);
+            for (int j = by - k; j <= by + k; j += step) {
+                if (j < 0 || j >= this->_block_num_y) {
+                    continue;
+                }
+                int index = this->block_index(i, j);
+                for (int b = this->_block_begin[index]; b < this->_block_begin[index + 1]; b++) {
+                    float d = box_distance(this->_boxes[b], x, y, z);
+                    if (d < best) {
+                        best = d;
+                        best_box = b;
+                    }
+                }
+            }
+        }
+    }
+
+    voxel.distance = best;
+    if (best <= 0 && best_box >= 0) {
+        voxel.semantic = this->_boxes[best_box].semantic;
+        return &voxel;
+    }
+    // 空中位置取正下方实体的语义
+    voxel.semantic = this->ground_semantic(x, y, bx, by);
+    int index = this->block_index(bx, by);
+    for (int b = this->_block_begin[index]; b < this->_block_begin[index + 1]; b++) {
+        const Box& box = this->_boxes[b];
+        if (x >= box.min_x && x <= box.max_x && y >= box.min_y && y <= box.max_y) {
+            voxel.semantic = box.semantic;
+            break;
+        }
+    }
+    return &voxel;
+}
+
+}  // namespace mtuav::algorithm
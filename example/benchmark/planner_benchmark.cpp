@@ -0,0 +1,208 @@
+#include <glog/logging.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "astar_3d.h"
+#include "dstar_lite.h"
+#include "grid_builder.h"
+#include "hierarchical_planner.h"
+#include "occupancy_pyramid.h"
+#include "segment_collision_checker.h"
+#include "semantic_cost_map.h"
+#include "synthetic_map.h"
+
+using namespace mtuav::algorithm;
+using namespace mtuav;
+
+// 离线性能测试：在SyntheticMap上测量网格构建与各规划器的耗时，不依赖地图文件和比赛服务器
+// 用法：planner_benchmark [地图边长(米), 默认3000] [路径数, 默认50]
+// 地图与起终点均由固定的seed生成，同一参数在任何机器上测试的是相同的问题
+
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// 在第z层随机选取一个不被占据的cell
+AStar::Vec2i random_free_cell(const OccupancyGrid& grid, int z, std::mt19937& random) {
+    while (true) {
+        AStar::Vec2i cell{int(random() % grid.size_x()), int(random() % grid.size_y())};
+        if (!grid.occupied(cell.x, cell.y, z)) {
+            return cell;
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    FLAGS_logtostderr = true;
+    google::InitGoogleLogging("planner_benchmark");
+    float map_size = (argc > 1) ? std::atof(argv[1]) : 3000;
+    int route_num = (argc > 2) ? std::atoi(argv[2]) : 50;
+    // TrajectoryGeneration会向标准输出打印大量调试信息，这里不需要
+    std::cout.setstate(std::ios::failbit);
+
+    SyntheticMapConfig config;
+    config.size_x = map_size;
+    config.size_y = map_size;
+    auto start = std::chrono::steady_clock::now();
+    auto map = std::make_shared<SyntheticMap>(config);
+    LOG(INFO) << "合成地图生成耗时 " << elapsed_ms(start) << " ms";
+
+    // 网格构建
+    GridBuilder builder(map, 10, 10, 10);
+    OccupancyGrid grid = builder.build();
+    const GridBuildStats& stats = builder.stats();
+    LOG(INFO) << "网格构建: " << grid.size_x() << "x" << grid.size_y() << "x" << grid.size_z()
+              << ", Query " << stats.query_count << " 次, 跳过 " << stats.skipped_count
+              << " 个cell, " << stats.thread_num << " 线程, 耗时 " << stats.elapsed_ms << " ms";
+
+    start = std::chrono::steady_clock::now();
+    OccupancyPyramid pyramid;
+    pyramid.build(grid, 4);
+    SemanticCostMap semantic_costs;
+    semantic_costs.build(map, grid);
+    LOG(INFO) << "金字塔与语义代价层构建耗时 " << elapsed_ms(start) << " ms";
+
+    int layer = grid.world_to_cell_z(90);
+    std::mt19937 random(1);
+    std::vector<std::pair<AStar::Vec2i, AStar::Vec2i>> routes;
+    for (int i = 0; i < route_num; i++) {
+        AStar::Vec2i source = random_free_cell(grid, layer, random);
+        routes.push_back({source, random_free_cell(grid, layer, random)});
+    }
+
+    // 分层二维规划
+    AStar::SearchWorkspace workspace;
+    HierarchicalPlanner planner(pyramid);
+    planner.set_cost_layer(&semantic_costs.layer());
+    planner.set_workspace(&workspace);
+    int reached = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto& [source, target] : routes) {
+        reached += HierarchicalPlanner::reached(planner.find_path(source, target, layer), target);
+    }
+    LOG(INFO) << "分层规划: " << reached << "/" << route_num << " 条到达, 平均耗时 "
+              << elapsed_ms(start) / route_num << " ms";
+
+    // 三维规划与拐点合并
+    DroneLimits limits{};
+    limits.max_fly_speed_h = 20;
+    limits.max_fly_speed_v = 5;
+    limits.max_fly_acc_h = 5;
+    limits.max_fly_acc_v = 2;
+    AStar3D astar_3d(grid, limits);
+    astar_3d.set_altitude_range(70, 110);
+    astar_3d.set_climb_penalty(4);
+    astar_3d.set_cost_layer(&semantic_costs.layer());
+    SegmentCollisionChecker checker(grid);
+    checker.set_cost_layer(&semantic_costs.layer());
+    double search_ms = 0, merge_ms = 0, flight_time = 0;
+    int64_t expanded_nodes = 0;
+    int found = 0, corner_num = 0, merged_num = 0;
+    for (auto& [source, target] : routes) {
+        start = std::chrono::steady_clock::now();
+        auto path = astar_3d.find_path({source.x, source.y, layer}, {target.x, target.y, layer});
+        search_ms += elapsed_ms(start);
+        expanded_nodes += astar_3d.expanded_nodes();
+        if (path.empty()) {
+            continue;
+        }
+        start = std::chrono::steady_clock::now();
+        auto corners = astar_3d.merge_corners(path, checker);
+        merge_ms += elapsed_ms(start);
+        found++;
+        flight_time += astar_3d.path_time();
+        corner_num += AStar3D::corner_points(path).size();
+        merged_num += corners.size();
+    }
+    if (found > 0) {
+        LOG(INFO) << "三维规划: " << found << "/" << route_num << " 条找到, 平均耗时 "
+                  << search_ms / route_num << " ms, 扩展 " << expanded_nodes / route_num
+                  << " 个节点, 飞行时间 " << flight_time / found << " s";
+        LOG(INFO) << "拐点合并: " << double(corner_num) / found << " -> "
+                  << double(merged_num) / found << " 个拐点, 平均耗时 " << merge_ms / found
+                  << " ms";
+    }
+
+    // D* Lite重规划：沿路径前进，每步在路径中段放置移动的临时障碍后重新规划
+    const AStar::CollisionLayer* collision_layer = pyramid.collision_layer(0, layer);
+    double initial_ms = 0, replan_ms = 0;
+    int replan_num = 0;
+    for (auto& [source, target] : routes) {
+        DStarLite replanner;
+        replanner.reset(collision_layer, &semantic_costs.layer(), target);
+        AStar::Vec2i position = source;
+        for (int step = 0; step < 8; step++) {
+            AStar::CoordinateList obstacles;
+            for (int k = 0; k < 6; k++) {
+                int x = (position.x + target.x) / 2 + int(random() % 40) - 20;
+                int y = (position.y + target.y) / 2 + int(random() % 40) - 20;
+                for (int j = 0; j < 8; j++) {
+                    obstacles.push_back({x + j, y});
+                }
+            }
+            start = std::chrono::steady_clock::now();
+            auto path = replanner.find_path(position, obstacles);
+            if (step == 0) {
+                initial_ms += elapsed_ms(start);
+            } else {
+                replan_ms += elapsed_ms(start);
+                replan_num++;
+            }
+            if (path.size() <= 6) {
+                break;
+            }
+            position = path[path.size() - 6];
+        }
+    }
+    LOG(INFO) << "D* Lite: 首次规划平均 " << initial_ms / route_num << " ms, 重规划 "
+              << replan_num << " 次, 平均 " << (replan_num > 0 ? replan_ms / replan_num : 0)
+              << " ms";
+
+    // 双向A*：最细层的临时障碍把终点围住时，单向搜索要扩展起点所在的整个连通区域才能确认不可达
+    auto search_2d = [&](AStar::Vec2i source, AStar::Vec2i target,
+                         const AStar::CoordinateList& obstacles, bool bidirectional,
+                         double& total_ms, int64_t& total_nodes) {
+        AStar::Generator generator;
+        generator.setWorldSize({grid.size_x(), grid.size_y()});
+        generator.setWorkspace(&workspace);
+        generator.setHeuristic(AStar::Heuristic::octagonal);
+        generator.setDiagonalMovement(true);
+        generator.setCollisionLayer(collision_layer);
+        generator.setCostLayer(&semantic_costs.layer());
+        generator.setBidirectional(bidirectional);
+        for (auto& coordinate : obstacles) {
+            generator.addCollision(coordinate);
+        }
+        start = std::chrono::steady_clock::now();
+        generator.findPath(source, target);
+        total_ms += elapsed_ms(start);
+        total_nodes += generator.getExpandedNodes();
+    };
+    for (bool bidirectional : {false, true}) {
+        double open_ms = 0, enclosed_ms = 0;
+        int64_t open_nodes = 0, enclosed_nodes = 0;
+        for (auto& [source, target] : routes) {
+            // 以终点为中心、边长7个cell的一圈临时障碍
+            AStar::CoordinateList ring;
+            for (int d = -3; d <= 3; d++) {
+                ring.push_back({target.x + d, target.y - 3});
+                ring.push_back({target.x + d, target.y + 3});
+                ring.push_back({target.x - 3, target.y + d});
+                ring.push_back({target.x + 3, target.y + d});
+            }
+            search_2d(source, target, {}, bidirectional, open_ms, open_nodes);
+            search_2d(source, target, ring, bidirectional, enclosed_ms, enclosed_nodes);
+        }
+        LOG(INFO) << (bidirectional ? "双向" : "单向") << "A*: 可达查询平均 "
+                  << open_ms / route_num << " ms, 扩展 " << open_nodes / route_num
+                  << " 个节点; 终点被围住平均 " << enclosed_ms / route_num << " ms, 扩展 "
+                  << enclosed_nodes / route_num << " 个节点";
+    }
+    return 0;
+}
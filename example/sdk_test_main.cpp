@@ -6,14 +6,14 @@
 #include <thread>
 #include "algorihtm.h"
 #include "current_game_info.h"
+#include "grid_builder.h"
+#include "grid_cache.h"
 #include "mtuav_sdk.h"
 #include "planner.h"
 
 using namespace mtuav::algorithm;
 using namespace mtuav;
 
-// 初始化算法类静态成员变量 
-int64_t Algorithm::flightplan_num = 0;
 bool task_stop = false;
 
 void sigint_handler(int sig) {
@@ -38,8 +38,8 @@ int main(int argc, const char* argv[]) {
     // 配置本地路径读取地图信息
     // auto map = mtuav::Map::CreateMapFromFile(
     //     "/home/siyuan/Desktop/mtuav925/map/test_map.bin");
-    auto map = mtuav::Map::CreateMapFromFile(
-    "../map/test_map.bin");
+    std::string map_path = "../map/test_map.bin";
+    auto map = mtuav::Map::CreateMapFromFile(map_path);
     // 声明一个planner指针
     std::shared_ptr<Planner> planner = std::make_shared<Planner>(map);
     // LOG 打印是否成功读取地图
@@ -93,72 +93,41 @@ int main(int argc, const char* argv[]) {
     LOG(INFO) << "An instance of contestant's algorihtm class is created. ";
 
     // 通过map计算map_grid
-    float min_x, min_y, min_z, max_x, max_y, max_z;
     int cell_size_x = 10;
     int cell_size_y = 10;
     int cell_size_z = 10;
-    map->Range(&min_x, &max_x, &min_y, &max_y, &min_z, &max_z);
-    std::vector<std::vector<std::vector<int>>> map_grid(
-        (int)((max_x - min_x) / cell_size_x), std::vector<std::vector<int>>(
-            (int)((max_y - min_y) / cell_size_y), std::vector<int>(
-                (int)((max_z - min_z) / cell_size_z), 0
-            )
-        )
-    );
-    LOG(INFO) << "开始计算网格...";
-    // std::vector<Grid3> pass_list; // 记录无需再查询的坐标(x, y, z)
-    for (int x = 0; x < map_grid.size(); x++) {
-        for (int y = 0; y < map_grid[x].size(); y++) {
-            for (int z = 0; z < map_grid[x][y].size(); z++) {
-                // bool pass_query = false;
-                // for (const Grid3& pass : pass_list) {
-                //     if (x == pass.x &&
-                //         y == pass.y &&
-                //         z == pass.z) {
-                //             pass_query = true; // 在pass_list上，无需再查询
-                //             break;
-                //         }
-                // }
-                // if (pass_query) {
-                //     continue;
-                // }
-                float mid_x, mid_y, mid_z; // 每个cell的中心点坐标
-                mid_x = x * cell_size_x + 0.5 * cell_size_x;
-                mid_y = y * cell_size_y + 0.5 * cell_size_y;
-                mid_z = z * cell_size_z + 0.5 * cell_size_z;
-                const Voxel* voxel = map->Query(mid_x, mid_y, mid_z);
-                if (voxel != nullptr) {
-                    if (voxel->distance > 0.5 * cell_size_x) {
-                        map_grid[x][y][z] = 0; // 无障碍物
-                        // int pass_x_n = (voxel->distance - 0.5 * cell_size_x) / cell_size_x;
-                        // int pass_y_n = (voxel->distance - 0.5 * cell_size_y) / cell_size_y;
-                        // int pass_z_n = (voxel->distance - 0.5 * cell_size_z) / cell_size_z;
-                        // for (int i = x + pass_x_n; i > x - pass_x_n; i--) {
-                        //     for (int j = y + pass_y_n; j > y - pass_y_n; j--) {
-                        //         for (int k = z + pass_z_n; k > z - pass_z_n; k--) {
-                        //             if (i >= 0 && i < map_grid.size() &&
-                        //                 j >= 0 && j < map_grid[i].size() &&
-                        //                 k >= 0 && k < map_grid[i][j].size()) {
-                        //                     Grid3 grid3 = {i, j, k};
-                        //                     pass_list.push_back(grid3);
-                        //                 } // 待改进，其实应该是球形
-                        //         }
-                        //     }
-                        // }
-
-
-                    } else {
-                        map_grid[x][y][z] = 1; // 有障碍物
-                    }
-                }
-            }
+    // 地图未变化时直接mmap上次计算的网格
+    GridCache grid_cache;
+    uint64_t grid_key =
+        GridCache::make_key(map_path, map.get(), cell_size_x, cell_size_y, cell_size_z);
+    OccupancyGrid map_grid;
+    if (grid_cache.load(grid_key, map_grid)) {
+        LOG(INFO) << "从缓存加载网格: " << grid_cache.cache_path(grid_key);
+    } else {
+        LOG(INFO) << "开始计算网格...";
+        // 按tile并行查询地图，线程数默认取硬件并发数
+        GridBuilder grid_builder(map, cell_size_x, cell_size_y, cell_size_z);
+        map_grid = grid_builder.build();
+        if (grid_cache.save(grid_key, map_grid)) {
+            LOG(INFO) << "网格已写入缓存: " << grid_cache.cache_path(grid_key);
         }
     }
     alg->_map_grid = std::move(map_grid); // 减少开销，相当于引用
-    alg->_cell_size_x = cell_size_x;
-    alg->_cell_size_y = cell_size_y;
-    alg->_cell_size_z = cell_size_z;
-    LOG(INFO) << "网格计算完毕...";
+    // 10/20/40/80m四层金字塔
+    alg->_grid_pyramid.build(alg->_map_grid, 4);
+    // ALT距离表在后台计算（或从网格缓存目录读取），完成前规划使用几何启发函数
+    std::vector<int> landmark_layers;
+    for (int altitude = 70; altitude <= 110; altitude += 10) {
+        landmark_layers.push_back(alg->_map_grid.world_to_cell_z(altitude));
+    }
+    alg->_landmarks.build_async(alg->_grid_pyramid, landmark_layers, 8, &grid_cache, grid_key);
+    // 70~110m巡航高度的距离层，与_altitude_drone_count一一对应
+    alg->_esdf_layers.build(map, {70, 80, 90, 100, 110}, 0.5 * cell_size_x, &grid_cache,
+                            grid_key);
+    // 语义代价层：避开危险区域，优先沿道路飞行
+    alg->_semantic_costs.build(map, alg->_map_grid, &grid_cache, grid_key);
+    LOG(INFO) << "网格计算完毕，占据cell数: " << alg->_map_grid.count_occupied()
+              << ", 内存: " << alg->_map_grid.memory_bytes() << " bytes";
 
 
     // 启动对应的比赛任务